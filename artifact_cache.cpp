@@ -0,0 +1,66 @@
+/**
+ * @file    artifact_cache.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements ArtifactCache; a content-addressed store of derived data
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <fmt/format.h>
+#include <filesystem>
+
+#include "artifact_cache.h"
+
+/// Use the given directory; it's created if necessary
+ArtifactCache::ArtifactCache(std::string_view dir)
+    : m_dir(dir)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(m_dir, ec);
+    m_valid = std::filesystem::is_directory(m_dir, ec);
+}
+
+/// Returns the file name of an artifact
+std::string ArtifactCache::GetPath(std::string_view name, uint64_t version,
+    uint64_t content_hash) const
+{
+    return (std::filesystem::path(m_dir) /
+        fmt::format("{}-v{}-{:016x}.bin", name, version, content_hash)).string();
+}
+
+/// Map an artifact if it's in the cache
+bool ArtifactCache::Lookup(std::string_view name, uint64_t version, uint64_t content_hash,
+    MappedFile& file) const
+{
+    return m_valid && file.Open(GetPath(name, version, content_hash));
+}
+
+/// Store an artifact in the cache
+bool ArtifactCache::Store(std::string_view name, uint64_t version, uint64_t content_hash,
+    std::span<const std::byte> image) const
+{
+    return m_valid && SaveImageFile(GetPath(name, version, content_hash), image);
+}
+
+/// Remove an artifact from the cache, such as one found to be damaged
+bool ArtifactCache::Remove(std::string_view name, uint64_t version,
+    uint64_t content_hash) const
+{
+    std::error_code ec;
+    return m_valid && std::filesystem::remove(GetPath(name, version, content_hash), ec);
+}
+
+/// Map an artifact, building and storing it first if necessary
+bool ArtifactCache::LookupOrBuild(std::string_view name, uint64_t version,
+    uint64_t content_hash, const Builder& build, MappedFile& file) const
+{
+    if (Lookup(name, version, content_hash, file))
+        return true;
+
+    // Two processes may race to build the same artifact. That's harmless;
+    // both produce the same bytes and the last rename wins.
+    ImageWriter out;
+    build(out);
+    return Store(name, version, content_hash, out.GetData()) &&
+        Lookup(name, version, content_hash, file);
+}
@@ -0,0 +1,69 @@
+/**
+ * @file    artifact_cache.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares ArtifactCache; a content-addressed store of derived data
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef artifact_cache__header_included
+#define artifact_cache__header_included
+
+#include <string_view>
+#include <functional>
+#include <cstdint>
+#include <string>
+#include <span>
+
+#include "dict_image.h"
+
+/**
+ * @brief A directory of artifacts derived from word lists
+ *
+ * Everything derived from a word list is a pure function of the list's
+ * contents and of the algorithm that built it. Artifacts are therefore
+ * filed under the hash of the (normalized) word list plus the name and
+ * version of the artifact; a changed list or algorithm simply never finds
+ * the old file. Artifacts are mapped read-only and are stored atomically,
+ * so any number of processes can share a cache directory.
+ */
+class ArtifactCache {
+public:
+
+    /// Builds an artifact image when it isn't in the cache
+    using Builder = std::function<void(ImageWriter&)>;
+
+    // -- Construction
+
+    /// Use the given directory; it's created if necessary
+    explicit ArtifactCache(std::string_view dir);
+
+    // -- Methods
+
+    /// Returns the file name of an artifact
+    std::string GetPath(std::string_view name, uint64_t version, uint64_t content_hash) const;
+
+    /// Map an artifact if it's in the cache
+    bool Lookup(std::string_view name, uint64_t version, uint64_t content_hash,
+        MappedFile& file) const;
+    /// Store an artifact in the cache
+    bool Store(std::string_view name, uint64_t version, uint64_t content_hash,
+        std::span<const std::byte> image) const;
+
+    /// Remove an artifact from the cache, such as one found to be damaged
+    bool Remove(std::string_view name, uint64_t version, uint64_t content_hash) const;
+
+    /// Map an artifact, building and storing it first if necessary
+    bool LookupOrBuild(std::string_view name, uint64_t version, uint64_t content_hash,
+        const Builder& build, MappedFile& file) const;
+
+    /// Returns true if the cache directory is usable
+    bool IsValid() const noexcept { return m_valid; }
+
+private:
+
+    std::string             m_dir;              ///< Cache directory
+    bool                    m_valid{false};     ///< Cache directory exists
+};
+
+#endif // ifndef artifact_cache__header_included
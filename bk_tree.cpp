@@ -0,0 +1,187 @@
+/**
+ * @file    bk_tree.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements BkTree; a metric index used for "did you mean" lookups
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <algorithm>
+#include <numeric>
+
+#include "bk_tree.h"
+
+/// Build the tree over the given word list into an image
+void BkTree::Build(const PackedWords& words, ImageWriter& out)
+{
+    NodeVect nodes;
+    nodes.reserve(words.size());
+
+    for (uint32_t w = 0; w < words.size(); ++w)
+        Insert(nodes, words, PackedWords(), w);
+
+    out.Write(std::span<const Node>(nodes));
+    PackedWords(std::span<const char>(), words.GetWordSize()).Save(out);
+}
+
+/// Build the tree over words into an image, starting from the tree base
+void BkTree::Update(const BkTree& base, const PackedWords& base_words,
+    const PackedWords& words, ImageWriter& out)
+{
+    // Where each base word went; no_word if it was removed
+    std::vector<uint32_t> to_new(base_words.size(), PackedWords::no_word);
+    const auto from_base = words.MapFrom(base_words);
+    for (uint32_t w = 0; w < from_base.size(); ++w) {
+        if (from_base[w] != PackedWords::no_word)
+            to_new[from_base[w]] = w;
+    }
+
+    // Keep the shape of the base tree. A removed word can't simply be
+    // unlinked since its children are placed by their distance to it, so
+    // it stays on as a tombstone: searched through but never returned.
+    NodeVect nodes(base.m_nodes.begin(), base.m_nodes.end());
+    std::vector<char> tomb_letters(base.m_tombstones.GetLetters().begin(),
+        base.m_tombstones.GetLetters().end());
+    std::vector<uint8_t> placed(words.size(), 0);
+    for (auto& n : nodes) {
+        if (n.word & tombstone_bit)
+            continue;
+        if (to_new[n.word] == PackedWords::no_word) {
+            const auto word = base.GetNodeWord(base_words, n);
+            n.word = tombstone_bit | static_cast<uint32_t>(tomb_letters.size() / words.GetWordSize());
+            tomb_letters.insert(tomb_letters.end(), word.begin(), word.end());
+        }
+        else {
+            n.word = to_new[n.word];
+            placed[n.word] = 1;
+        }
+    }
+
+    // Compact once tombstones make up a good part of the tree
+    const PackedWords tombs(tomb_letters, words.GetWordSize());
+    if (tombs.size() * 4 > nodes.size()) {
+        Build(words, out);
+        return;
+    }
+
+    for (uint32_t w = 0; w < words.size(); ++w) {
+        if (!placed[w])
+            Insert(nodes, words, tombs, w);
+    }
+
+    out.Write(std::span<const Node>(nodes));
+    tombs.Save(out);
+}
+
+/// Add word w to the tree
+void BkTree::Insert(NodeVect& nodes, const PackedWords& words,
+    const PackedWords& tombs, uint32_t w)
+{
+    if (nodes.empty()) {
+        nodes.push_back(Node{w, 0});
+        return;
+    }
+
+    // Walk down from the root until we find a free edge for this distance
+    uint32_t n = 0;
+    while (1) {
+        const Node& node = nodes[n];
+        const auto node_word = (node.word & tombstone_bit) ?
+            tombs[node.word & ~tombstone_bit] : words[node.word];
+        auto d = static_cast<uint32_t>(Distance(node_word, words[w]));
+        if (0 == d) {
+            // Duplicate word; nothing to add unless it's coming back
+            if (node.word & tombstone_bit)
+                nodes[n].word = w;
+            return;
+        }
+
+        uint32_t c = node.first_child;
+        while ((c != no_node) && (nodes[c].dist != d))
+            c = nodes[c].next_sibling;
+        if (c != no_node) {
+            n = c;
+            continue;
+        }
+
+        // No child at this distance; new word becomes one
+        auto idx = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(Node{w, d, no_node, nodes[n].first_child});
+        nodes[n].first_child = idx;
+        return;
+    }
+}
+
+/// Load a view of a tree written by Build over word_count words
+bool BkTree::Load(ImageReader& in, size_t word_count) noexcept
+{
+    if (!in.Read(m_nodes) || !m_tombstones.Load(in))
+        return false;
+
+    // Make sure a damaged image can't send a search off into the weeds
+    return std::all_of(m_nodes.begin(), m_nodes.end(), [this, word_count](const Node& n) {
+        return ((n.first_child == no_node) || (n.first_child < m_nodes.size())) &&
+               ((n.next_sibling == no_node) || (n.next_sibling < m_nodes.size())) &&
+               ((n.word & tombstone_bit) ? ((n.word & ~tombstone_bit) < m_tombstones.size())
+                                         : (n.word < word_count));
+    });
+}
+
+/// Find up to max_count words within max_dist of word, closest first
+BkTree::MatchVect BkTree::Find(const PackedWords& words,
+    std::string_view word, size_t max_dist, size_t max_count) const
+{
+    MatchVect matches;
+    if (m_nodes.empty())
+        return matches;
+
+    std::vector<uint32_t> pending{0};
+    while (!pending.empty()) {
+        uint32_t n = pending.back();
+        pending.pop_back();
+
+        const auto d = Distance(GetNodeWord(words, m_nodes[n]), word);
+        if ((d <= max_dist) && !(m_nodes[n].word & tombstone_bit))
+            matches.push_back(Match{m_nodes[n].word, static_cast<uint32_t>(d)});
+
+        // Triangle inequality: only children in [d - max, d + max] can match
+        const size_t lo = (d > max_dist) ? d - max_dist : 0;
+        const size_t hi = d + max_dist;
+        for (uint32_t c = m_nodes[n].first_child; c != no_node; c = m_nodes[c].next_sibling) {
+            if ((m_nodes[c].dist >= lo) && (m_nodes[c].dist <= hi))
+                pending.push_back(c);
+        }
+    }
+
+    // Closest first; ties broken by word list order (alphabetical)
+    std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b)
+        { return (a.dist != b.dist) ? (a.dist < b.dist) : (a.word < b.word); });
+    if (matches.size() > max_count)
+        matches.resize(max_count);
+
+    return matches;
+}
+
+/// Levenshtein distance between two words
+size_t BkTree::Distance(std::string_view a, std::string_view b)
+{
+    if (a.length() < b.length())
+        std::swap(a, b);
+
+    // Words are short, so a single row of the DP matrix is plenty
+    std::vector<size_t> row(b.length() + 1);
+    std::iota(row.begin(), row.end(), 0);
+
+    for (size_t i = 1; i <= a.length(); ++i) {
+        size_t diag = row[0];
+        row[0] = i;
+        for (size_t j = 1; j <= b.length(); ++j) {
+            size_t up = row[j];
+            row[j] = std::min({up + 1, row[j-1] + 1,
+                diag + ((a[i-1] == b[j-1]) ? 0 : 1)});
+            diag = up;
+        }
+    }
+
+    return row[b.length()];
+}
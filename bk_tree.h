@@ -0,0 +1,96 @@
+/**
+ * @file    bk_tree.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares BkTree; a metric index used for "did you mean" lookups
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef bk_tree__header_included
+#define bk_tree__header_included
+
+#include <string_view>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <span>
+
+#include "packed_words.h"
+#include "dict_image.h"
+
+/**
+ * @brief A Burkhard-Keller tree over a word list
+ *
+ * Words are referenced by their index in the word list, so the tree itself
+ * is just a flat array of nodes. Children of a node are chained through
+ * next_sibling and are keyed by their edit distance to the parent. The
+ * nodes live in a dictionary image; this class is just a view of them.
+ *
+ * A tree can be updated for an edited word list without being rebuilt.
+ * Removed words remain as tombstones (their letters are kept with the
+ * tree) until there are enough of them to be worth a rebuild.
+ */
+class BkTree {
+public:
+
+    /// A word found by Find: index into the word list and its distance
+    struct Match {
+        uint32_t    word;       ///< Index of the word in the word list
+        uint32_t    dist;       ///< Edit distance from the query
+    };
+    using MatchVect = std::vector<Match>;
+
+    // -- Methods
+
+    /// Build the tree over the given word list into an image
+    static void Build(const PackedWords& words, ImageWriter& out);
+    /// Build the tree over words into an image, starting from the tree base
+    /// over base_words
+    static void Update(const BkTree& base, const PackedWords& base_words,
+        const PackedWords& words, ImageWriter& out);
+    /// Load a view of a tree written by Build over word_count words
+    bool Load(ImageReader& in, size_t word_count) noexcept;
+    /// Returns the (most) image bytes Build writes for word_count words
+    static size_t GetImageBytes(size_t word_count) noexcept
+        { return 3 * sizeof(uint64_t) + ImageReader::Pad(word_count * sizeof(Node)); }
+
+    /// Find up to max_count words within max_dist of word, closest first
+    MatchVect Find(const PackedWords& words, std::string_view word,
+        size_t max_dist, size_t max_count) const;
+
+    /// Returns the number of words in the tree, including tombstones
+    size_t GetNodeCount() const noexcept { return m_nodes.size(); }
+    /// Returns the number of removed words still in the tree
+    size_t GetTombstoneCount() const noexcept { return m_tombstones.size(); }
+
+    /// Levenshtein distance between two words
+    static size_t Distance(std::string_view a, std::string_view b);
+
+private:
+
+    static constexpr uint32_t no_node = UINT32_MAX;
+    /// Set in Node::word for a tombstone; the rest indexes m_tombstones
+    static constexpr uint32_t tombstone_bit = 0x80000000;
+
+    struct Node {
+        uint32_t    word;                   ///< Index of the word in the word list
+                                            ///< or a tombstone
+        uint32_t    dist;                   ///< Distance to parent word
+        uint32_t    first_child{no_node};   ///< First child node
+        uint32_t    next_sibling{no_node};  ///< Next node with the same parent
+    };
+
+    using NodeVect = std::vector<Node>;
+
+    /// Add word w to the tree
+    static void Insert(NodeVect& nodes, const PackedWords& words,
+        const PackedWords& tombs, uint32_t w);
+    /// Returns the word for a node
+    std::string_view GetNodeWord(const PackedWords& words, const Node& n) const noexcept
+        { return (n.word & tombstone_bit) ? m_tombstones[n.word & ~tombstone_bit] : words[n.word]; }
+
+    std::span<const Node>   m_nodes;        ///< m_nodes[0] is the root
+    PackedWords             m_tombstones;   ///< Removed words still in the tree
+};
+
+#endif // ifndef bk_tree__header_included
@@ -0,0 +1,113 @@
+/**
+ * @file    dict_image.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements the building blocks of a dictionary image
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "dict_image.h"
+
+void ImageWriter::Append(const void* data, size_t len)
+{
+    const size_t at = m_data.size();
+    m_data.resize(at + ImageReader::Pad(len));
+    if (len)
+        std::memcpy(m_data.data() + at, data, len);
+}
+
+/// Write an image to a file; the file is replaced atomically
+bool SaveImageFile(const std::string& path, std::span<const std::byte> image)
+{
+    // Write to a uniquely named file in the same directory and then rename
+    // it over the target. Processes that already mapped the old file keep
+    // their view of it and new processes see a complete image.
+    const auto tmp_path = path + ".tmp" + std::to_string(std::random_device()());
+    std::error_code ec;
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open())
+            return false;
+        ofs.write(reinterpret_cast<const char*>(image.data()),
+            static_cast<std::streamsize>(image.size()));
+        if (!ofs.flush()) {
+            ofs.close();
+            std::filesystem::remove(tmp_path, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+
+    return true;
+}
+
+/// Map the given file; returns false if it can't be opened
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+#if !defined(_WIN32)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if ((::fstat(fd, &st) != 0) || (st.st_size <= 0)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);    // Mapping stays valid
+    if (p == MAP_FAILED)
+        return false;
+
+    m_data = static_cast<const std::byte*>(p);
+    m_size = static_cast<size_t>(st.st_size);
+#else
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    if (!ifs.is_open())
+        return false;
+    m_private.resize(static_cast<size_t>(ifs.tellg()));
+    ifs.seekg(0);
+    if (!ifs.read(reinterpret_cast<char*>(m_private.data()),
+        static_cast<std::streamsize>(m_private.size())))
+    {
+        m_private.clear();
+        return false;
+    }
+
+    m_data = m_private.data();
+    m_size = m_private.size();
+#endif
+
+    return true;
+}
+
+/// Unmap the file
+void MappedFile::Close() noexcept
+{
+#if !defined(_WIN32)
+    if (m_data)
+        ::munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+    m_private.clear();
+    m_data = nullptr;
+    m_size = 0;
+}
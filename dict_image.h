@@ -0,0 +1,147 @@
+/**
+ * @file    dict_image.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares the building blocks of a dictionary image
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef dict_image__header_included
+#define dict_image__header_included
+
+#include <type_traits>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <string>
+#include <span>
+
+/**
+ * @brief Serializes dictionary structures into a flat image
+ *
+ * An image is a sequence of 64-bit values and arrays. Each array is
+ * preceded by its element count and padded to an 8 byte boundary so that
+ * it can be used in place once the image is loaded or mapped.
+ */
+class ImageWriter {
+public:
+
+    /// Append a single value
+    void WriteValue(uint64_t value) { Append(&value, sizeof(value)); }
+
+    /// Append an array of trivially copyable items
+    template <typename T>
+    void Write(std::span<const T> items)
+    {
+        static_assert(std::is_trivially_copyable_v<T> && (alignof(T) <= 8));
+        WriteValue(items.size());
+        Append(items.data(), items.size_bytes());
+    }
+
+    /// Returns the image contents
+    const std::vector<std::byte>& GetData() const noexcept { return m_data; }
+    /// Moves the image contents out of the writer
+    std::vector<std::byte> Take() noexcept { return std::move(m_data); }
+
+private:
+
+    void Append(const void* data, size_t len);
+
+    std::vector<std::byte>  m_data;
+};
+
+/**
+ * @brief Reads structures back out of an image without copying them
+ *
+ * Arrays are returned as spans into the image, so the image must outlive
+ * everything that is read from it. All reads are bounds checked; a failed
+ * read leaves the reader in a failed state.
+ */
+class ImageReader {
+public:
+
+    explicit ImageReader(std::span<const std::byte> image) noexcept
+        : m_image(image) {}
+
+    /// Read a single value
+    bool ReadValue(uint64_t& value) noexcept
+    {
+        if (!Check(sizeof(value)))
+            return false;
+        std::memcpy(&value, m_image.data() + m_offset, sizeof(value));
+        m_offset += sizeof(value);
+        return true;
+    }
+
+    /// Read an array of items
+    template <typename T>
+    bool Read(std::span<const T>& items) noexcept
+    {
+        uint64_t count;
+        if (!ReadValue(count) || (count > m_image.size() / sizeof(T)) || !Check(Pad(count * sizeof(T))))
+            return false;
+        items = {reinterpret_cast<const T*>(m_image.data() + m_offset), static_cast<size_t>(count)};
+        m_offset += Pad(count * sizeof(T));
+        return true;
+    }
+
+    /// Returns true if all reads so far succeeded
+    bool IsOk() const noexcept { return m_ok; }
+
+    /// Rounds len up to the image alignment
+    static constexpr size_t Pad(size_t len) noexcept { return (len + 7) & ~size_t(7); }
+
+private:
+
+    bool Check(size_t len) noexcept
+        { return m_ok = m_ok && (len <= m_image.size() - m_offset); }
+
+    std::span<const std::byte>  m_image;
+    size_t                      m_offset{0};
+    bool                        m_ok{true};
+};
+
+/// Write an image to a file; the file is replaced atomically
+bool SaveImageFile(const std::string& path, std::span<const std::byte> image);
+
+/**
+ * @brief A read-only view of a whole file
+ *
+ * On POSIX systems the file is memory mapped and shared with every other
+ * process that maps it. Elsewhere it is read into private memory.
+ */
+class MappedFile {
+public:
+
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Map the given file; returns false if it can't be opened
+    bool Open(const std::string& path);
+    /// Unmap the file
+    void Close() noexcept;
+    /// Exchange mappings with another object
+    void Swap(MappedFile& other) noexcept
+    {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        m_private.swap(other.m_private);
+    }
+
+    /// Returns the contents of the file
+    std::span<const std::byte> GetData() const noexcept { return {m_data, m_size}; }
+
+private:
+
+    const std::byte*        m_data{nullptr};
+    size_t                  m_size{0};
+    std::vector<std::byte>  m_private;          ///< Contents when not mapped
+};
+
+#endif // ifndef dict_image__header_included
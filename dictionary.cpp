@@ -0,0 +1,177 @@
+/**
+ * @file    dictionary.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements Dictionary; a loaded word list and everything derived from it
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+
+#include "dictionary.h"
+#include "util.h"
+
+/// Build from a list of same-length words
+void Dictionary::Build(std::vector<std::string> words, Weights weights,
+    uint64_t source_stamp, const Options& options, const Dictionary* base)
+{
+    // Make sure list is sorted so we can quickly search
+    Sort(words, weights);
+
+    ImageWriter out;
+    Write(words, weights, source_stamp, out, options, base);
+
+    m_mapping.Close();
+    m_image = out.Take();
+    Load(m_image, source_stamp);
+}
+
+/// Write the image for a sorted list of same-length words
+void Dictionary::Write(const std::vector<std::string>& words, const Weights& weights,
+    uint64_t source_stamp, ImageWriter& out, const Options& options, const Dictionary* base)
+{
+    const size_t word_size = words.empty() ? 0 : words[0].length();
+    const auto letters = PackedWords::Pack(words);
+    const PackedWords packed(letters, word_size);
+
+    out.WriteValue(image_magic);
+    out.WriteValue(image_version);
+    out.WriteValue(source_stamp);
+    out.WriteValue(HashWords(words, weights));
+    packed.Save(out);
+    out.Write(std::span<const float>(weights));
+    WordColumns::Build(packed, out, options.positional_index);
+
+    // The columns are linear to build, the tree isn't. Grow the tree from
+    // the base's if it has one; a tree over no words is how an image says
+    // it has no tree.
+    if (!options.word_tree)
+        BkTree::Build(PackedWords(), out);
+    else if (base && base->GetWordTree().GetNodeCount() && (base->GetWordSize() == word_size))
+        BkTree::Update(base->GetWordTree(), base->GetWords(), packed, out);
+    else
+        BkTree::Build(packed, out);
+}
+
+/// Sort words, keeping their weights (if any) with them
+void Dictionary::Sort(std::vector<std::string>& words, Weights& weights)
+{
+    if (weights.empty()) {
+        std::sort(words.begin(), words.end());
+        return;
+    }
+
+    std::vector<uint32_t> order(words.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+        [&words](uint32_t a, uint32_t b) { return words[a] < words[b]; });
+
+    std::vector<std::string> sorted_words(words.size());
+    Weights sorted_weights(words.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        sorted_words[i] = std::move(words[order[i]]);
+        sorted_weights[i] = weights[order[i]];
+    }
+    words.swap(sorted_words);
+    weights.swap(sorted_weights);
+}
+
+/// Returns the image bytes needed for a word list of the given shape
+Dictionary::Footprint Dictionary::GetFootprint(size_t word_count, size_t word_size,
+    bool weighted)
+{
+    Footprint fp;
+    const size_t header  = 4 * sizeof(uint64_t);
+    const size_t packed  = 2 * sizeof(uint64_t) + ImageReader::Pad(word_count * word_size);
+    const size_t weights = sizeof(uint64_t) +
+        (weighted ? ImageReader::Pad(word_count * sizeof(float)) : 0);
+    const size_t columns = WordColumns::GetImageBytes(word_count, word_size, false);
+    fp.base = header + packed + weights + columns + BkTree::GetImageBytes(0);
+    fp.positional_index = WordColumns::GetImageBytes(word_count, word_size, true) - columns;
+    fp.word_tree = BkTree::GetImageBytes(word_count) - BkTree::GetImageBytes(0);
+
+    return fp;
+}
+
+/// Hash of a sorted word list; identifies everything derived from it
+uint64_t Dictionary::HashWords(const std::vector<std::string>& words,
+    const Weights& weights)
+{
+    uint64_t hash = hash_fnv1a("");
+    for (const auto& w : words)
+        hash = hash_fnv1a("\n", hash_fnv1a(w, hash));
+
+    // Unweighted lists hash as they always have
+    if (!weights.empty()) {
+        hash = hash_fnv1a(std::string_view(reinterpret_cast<const char*>(weights.data()),
+            weights.size() * sizeof(float)), hash);
+    }
+
+    return hash;
+}
+
+/// Attach to a published image; fails if it's missing, damaged, or stale
+bool Dictionary::Attach(const std::string& path, uint64_t source_stamp)
+{
+    MappedFile mapping;
+    return mapping.Open(path) && Attach(mapping, source_stamp);
+}
+
+/// Attach to a mapped image, taking over the mapping on success
+bool Dictionary::Attach(MappedFile& mapping, uint64_t source_stamp)
+{
+    if (!Load(mapping.GetData(), source_stamp)) {
+        // Go back to viewing whatever image we had before
+        Load(GetImage(), 0);
+        return false;
+    }
+
+    m_image = std::vector<std::byte>();
+    m_mapping.Swap(mapping);
+    return true;
+}
+
+/// Publish the image to a file so other processes can attach to it
+bool Dictionary::Publish(const std::string& path, uint64_t source_stamp) const
+{
+    const auto image = GetImage();
+    if (!source_stamp || (image.size() < 3 * sizeof(uint64_t)))
+        return SaveImageFile(path, image);
+
+    // An image from the artifact cache is stamped with its content hash;
+    // the stamp follows the magic and version
+    std::vector<std::byte> copy(image.begin(), image.end());
+    std::memcpy(copy.data() + 2 * sizeof(uint64_t), &source_stamp, sizeof(source_stamp));
+    return SaveImageFile(path, copy);
+}
+
+/// Load views of everything in image
+bool Dictionary::Load(std::span<const std::byte> image, uint64_t source_stamp)
+{
+    ImageReader in(image);
+
+    uint64_t magic, version, stamp;
+    bool ok = in.ReadValue(magic) && (magic == image_magic) &&
+        in.ReadValue(version) && (version == image_version) &&
+        in.ReadValue(stamp) && (!source_stamp || (stamp == source_stamp)) &&
+        in.ReadValue(m_content_hash);
+
+    ok = ok && m_words.Load(in) && in.Read(m_weights) &&
+        (m_weights.empty() || (m_weights.size() == m_words.size())) &&
+        m_columns.Load(in) && m_word_tree.Load(in, m_words.size()) &&
+        (m_columns.GetWordCount() == m_words.size()) &&
+        (m_columns.GetWordSize() == m_words.GetWordSize());
+
+    // Never leave views pointing into an image we rejected
+    if (!ok) {
+        m_words     = PackedWords();
+        m_weights   = {};
+        m_columns   = WordColumns();
+        m_word_tree = BkTree();
+        m_content_hash = 0;
+    }
+
+    return ok;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file    dictionary.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares Dictionary; a loaded word list and everything derived from it
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef dictionary__header_included
+#define dictionary__header_included
+
+#include <string_view>
+#include <cstdint>
+#include <vector>
+#include <string>
+
+#include "word_columns.h"
+#include "packed_words.h"
+#include "dict_image.h"
+#include "bk_tree.h"
+
+/**
+ * @brief A loaded word list along with its indexes
+ *
+ * The packed words and every structure derived from them live in a single
+ * flat image. The image is either built in private memory or attached
+ * read-only from a file that another process published, in which case
+ * all processes share one copy of it.
+ */
+class Dictionary {
+public:
+
+    /// Which optional indexes to build
+    struct Options {
+        bool    positional_index{true};     ///< Word lists by (position, letter)
+        bool    word_tree{true};            ///< Edit distance index
+    };
+
+    /// Prior weight of each word (e.g., its frequency); empty if uniform
+    using Weights = std::vector<float>;
+
+    /// Image bytes for a word list: the part that's always built and each
+    /// optional index
+    struct Footprint {
+        size_t  base{0};
+        size_t  positional_index{0};
+        size_t  word_tree{0};
+    };
+
+    Dictionary() = default;
+
+    Dictionary(const Dictionary&) = delete;
+    Dictionary& operator=(const Dictionary&) = delete;
+
+    // -- Methods
+
+    /// Build from a list of same-length words and their (optional) weights,
+    /// reusing what it can from base (an earlier version of the list)
+    void Build(std::vector<std::string> words, Weights weights, uint64_t source_stamp,
+        const Options& options, const Dictionary* base = nullptr);
+    /// Write the image for a sorted list of same-length words
+    static void Write(const std::vector<std::string>& words, const Weights& weights,
+        uint64_t source_stamp, ImageWriter& out, const Options& options,
+        const Dictionary* base = nullptr);
+    /// Sort words, keeping their weights (if any) with them
+    static void Sort(std::vector<std::string>& words, Weights& weights);
+    /// Returns the image bytes needed for a word list of the given shape
+    static Footprint GetFootprint(size_t word_count, size_t word_size, bool weighted);
+
+    /// Attach to a published image; fails if it's missing, damaged, or stale
+    bool Attach(const std::string& path, uint64_t source_stamp);
+    /// Attach to a mapped image, taking over the mapping on success
+    bool Attach(MappedFile& mapping, uint64_t source_stamp);
+    /// Publish the image to a file so other processes can attach to it;
+    /// a nonzero source_stamp replaces the one the image was built with
+    bool Publish(const std::string& path, uint64_t source_stamp = 0) const;
+
+    /// Returns the number of words
+    size_t GetWordCount() const noexcept { return m_words.size(); }
+    /// Returns the length of each word
+    size_t GetWordSize() const noexcept { return m_words.GetWordSize(); }
+    /// Returns word i
+    std::string_view GetWord(size_t i) const noexcept { return m_words[i]; }
+
+    /// Returns the sorted word list
+    const PackedWords& GetWords() const noexcept { return m_words; }
+    /// Returns the column-major word store
+    const WordColumns& GetColumns() const noexcept { return m_columns; }
+    /// Returns the edit distance index
+    const BkTree& GetWordTree() const noexcept { return m_word_tree; }
+    /// Returns the prior weight of every word; empty if they're all equal
+    std::span<const float> GetWeights() const noexcept { return m_weights; }
+
+    /// Returns the hash of the word list contents; see HashWords
+    uint64_t GetContentHash() const noexcept { return m_content_hash; }
+    /// Hash of a sorted word list and its weights; identifies everything
+    /// derived from it
+    static uint64_t HashWords(const std::vector<std::string>& words,
+        const Weights& weights = Weights());
+
+    /// Returns the size of the image
+    size_t GetImageBytes() const noexcept { return GetImage().size(); }
+    /// Returns true if the image is attached from a file
+    bool IsAttached() const noexcept { return m_image.empty() && !m_mapping.GetData().empty(); }
+
+    /// Bump whenever the layout of anything in the image changes
+    static constexpr uint64_t image_version = 4;
+
+private:
+
+    /// Load views of everything in image
+    bool Load(std::span<const std::byte> image, uint64_t source_stamp);
+    /// Returns the whole image
+    std::span<const std::byte> GetImage() const noexcept
+        { return m_image.empty() ? m_mapping.GetData() : std::span<const std::byte>(m_image); }
+
+    /// Identifies a mrdle dictionary image: "mrdlDICT"
+    static constexpr uint64_t image_magic   = 0x544349446c64726d;
+    std::vector<std::byte>  m_image;            ///< Image when built privately
+    MappedFile              m_mapping;          ///< Image when attached
+
+    uint64_t                m_content_hash{0};  ///< Hash of the word list contents
+    PackedWords             m_words;            ///< Sorted word list
+    std::span<const float>  m_weights;          ///< Prior weight of each word, if any
+    WordColumns             m_columns;          ///< Column-major copy of m_words
+    BkTree                  m_word_tree;        ///< Metric index over m_words
+};
+
+#endif // ifndef dictionary__header_included
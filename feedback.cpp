@@ -0,0 +1,277 @@
+/**
+ * @file    feedback.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements feedback patterns; the clue for a guess as a number
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <algorithm>
+#include <charconv>
+#include <utility>
+#include <vector>
+
+#include "feedback.h"
+#include "mrdle.h"
+
+/// Returns the pattern for a guess; same rules as mrdle::CheckWordGuess
+Pattern ComputePattern(std::string_view secret, std::string_view guess) noexcept
+{
+    const size_t n = secret.length();
+
+    Pattern pattern = 0;
+    for (size_t i = n; i-- > 0; ) {
+        Pattern digit = pattern_missing;
+        if (guess[i] == secret[i])
+            digit = pattern_matched;
+        else {
+            // Letter is mislaid if it's anywhere in the secret that isn't
+            // already matched by the guess
+            for (size_t p = 0; p < n; ++p) {
+                if ((secret[p] == guess[i]) && (secret[p] != guess[p])) {
+                    digit = pattern_mislaid;
+                    break;
+                }
+            }
+        }
+        pattern = static_cast<Pattern>(pattern * 3 + digit);
+    }
+
+    return pattern;
+}
+
+/// Compute the pattern of guess against every word in the store
+void ComputePatternRow(const WordColumns& columns, std::string_view guess,
+    std::span<Pattern> row)
+{
+    // Same rules as ComputePattern, but worked a column at a time so that
+    // every step is a branch-free loop over all secrets.
+    const size_t n  = columns.GetWordCount();
+    const size_t ws = columns.GetWordSize();
+
+    // matched[p][s] is 1 if secret s has guess letter p at p
+    std::vector<uint8_t> matched(ws * n);
+    for (size_t p = 0; p < ws; ++p) {
+        const uint8_t* col = columns.GetColumn(p).data();
+        const auto g = static_cast<uint8_t>(guess[p]);
+        uint8_t* m = matched.data() + p * n;
+        for (size_t s = 0; s < n; ++s)
+            m[s] = (col[s] == g);
+    }
+
+    std::vector<uint8_t> mislaid(n);
+    std::fill(row.begin(), row.end(), Pattern(0));
+    Pattern weight = 1;
+    for (size_t i = 0; i < ws; ++i, weight = static_cast<Pattern>(weight * 3)) {
+
+        // Is guess letter i anywhere in the unmatched part of the secret?
+        std::fill(mislaid.begin(), mislaid.end(), uint8_t(0));
+        const auto g = static_cast<uint8_t>(guess[i]);
+        for (size_t p = 0; p < ws; ++p) {
+            const uint8_t* col = columns.GetColumn(p).data();
+            const uint8_t* m = matched.data() + p * n;
+            for (size_t s = 0; s < n; ++s)
+                mislaid[s] |= (col[s] == g) & (m[s] ^ 1);
+        }
+
+        const uint8_t* m = matched.data() + i * n;
+        Pattern* r = row.data();
+        for (size_t s = 0; s < n; ++s) {
+            const Pattern digit = m[s] ? pattern_matched : mislaid[s];
+            r[s] = static_cast<Pattern>(r[s] + digit * weight);
+        }
+    }
+}
+
+/// Returns the result string (mrdle::res_* characters) for a pattern
+std::string PatternToResult(Pattern pattern, size_t word_size)
+{
+    std::string result(word_size, mrdle::res_missing);
+    for (size_t i = 0; i < word_size; ++i, pattern /= 3) {
+        switch (pattern % 3) {
+        case pattern_matched: result[i] = mrdle::res_matched; break;
+        case pattern_mislaid: result[i] = mrdle::res_mislaid; break;
+        default: break;
+        }
+    }
+
+    return result;
+}
+
+/// Returns the results a result string could stand for
+std::vector<std::string> GetResultFills(std::string_view result)
+{
+    if (result.length() > max_pattern_word_size)
+        return {};
+    std::vector<size_t> unknown;
+    for (size_t i = 0; i < result.length(); ++i) {
+        switch (result[i]) {
+        case mrdle::res_matched:
+        case mrdle::res_mislaid:
+        case mrdle::res_missing: break;
+        case mrdle::res_any:     unknown.push_back(i); break;
+        default: return {};
+        }
+    }
+
+    // Count in base 3 over the unknowns
+    constexpr char digits[] = {mrdle::res_missing, mrdle::res_mislaid, mrdle::res_matched};
+    std::vector<std::string> fills;
+    fills.reserve(GetPatternCount(unknown.size()));
+    std::string fill(result);
+    for (size_t n = 0; n < GetPatternCount(unknown.size()); ++n) {
+        size_t v = n;
+        for (auto i : unknown) {
+            fill[i] = digits[v % 3];
+            v /= 3;
+        }
+        fills.push_back(fill);
+    }
+
+    return fills;
+}
+
+/// Parse a result string (mrdle::res_* characters)
+bool WordleFeedback::ParseClue(std::string_view text, size_t word_size, Pattern& pattern) noexcept
+{
+    if ((text.length() != word_size) || (word_size > max_pattern_word_size))
+        return false;
+
+    pattern = 0;
+    for (size_t i = word_size; i-- > 0; ) {
+        Pattern digit;
+        switch (text[i]) {
+        case mrdle::res_matched: digit = pattern_matched; break;
+        case mrdle::res_mislaid: digit = pattern_mislaid; break;
+        case mrdle::res_missing: digit = pattern_missing; break;
+        default: return false;
+        }
+        pattern = static_cast<Pattern>(pattern * 3 + digit);
+    }
+
+    return true;
+}
+
+/// Returns true if text is a result string, unknowns included
+bool WordleFeedback::ValidateClue(std::string_view text, size_t word_size) noexcept
+{
+    // Unknown results are matched by listing what they could be, so there
+    // can't be too many
+    constexpr char res_chars[] = {mrdle::res_matched, mrdle::res_missing, mrdle::res_mislaid,
+        mrdle::res_any};
+    if ((text.length() != word_size) ||
+        (text.find_first_not_of(std::string_view(res_chars, std::size(res_chars))) != text.npos))
+        return false;
+    return (text.find(mrdle::res_any) == text.npos) || (word_size <= max_pattern_word_size);
+}
+
+/// Returns the number of letters secret and guess have in common
+Pattern JottoFeedback::Compute(std::string_view secret, std::string_view guess) noexcept
+{
+    Pattern common = 0;
+    for (size_t i = 0; i < guess.length(); ++i) {
+        if (guess.find(guess[i]) != i)
+            continue;       // Counted at its first occurrence
+        const auto in_guess  = std::count(guess.begin(), guess.end(), guess[i]);
+        const auto in_secret = std::count(secret.begin(), secret.end(), guess[i]);
+        common = static_cast<Pattern>(common + std::min(in_guess, in_secret));
+    }
+
+    return common;
+}
+
+/// Compute the pattern of guess against every word in the store
+void JottoFeedback::ComputeRow(const WordColumns& columns, std::string_view guess,
+    std::span<Pattern> row)
+{
+    const size_t n  = columns.GetWordCount();
+    const size_t ws = columns.GetWordSize();
+
+    // One pass over the columns per distinct guess letter, counting it in
+    // every secret and then crediting as many as the guess has
+    std::vector<uint8_t> count(n);
+    std::fill(row.begin(), row.end(), Pattern(0));
+    for (size_t i = 0; i < ws; ++i) {
+        if (guess.find(guess[i]) != i)
+            continue;
+        const auto g = static_cast<uint8_t>(guess[i]);
+        const auto k = static_cast<uint8_t>(std::count(guess.begin(), guess.end(), guess[i]));
+
+        std::fill(count.begin(), count.end(), uint8_t(0));
+        for (size_t p = 0; p < ws; ++p) {
+            const uint8_t* col = columns.GetColumn(p).data();
+            for (size_t s = 0; s < n; ++s)
+                count[s] += (col[s] == g);
+        }
+
+        Pattern* r = row.data();
+        for (size_t s = 0; s < n; ++s)
+            r[s] = static_cast<Pattern>(r[s] + std::min(count[s], k));
+    }
+}
+
+/// Parse a count of letters, 0 up to the word size
+bool JottoFeedback::ParseClue(std::string_view text, size_t word_size, Pattern& pattern) noexcept
+{
+    const auto* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, pattern);
+    return (ec == std::errc()) && (ptr == end) && !text.empty() && (pattern <= word_size);
+}
+
+/// Returns the count as text
+std::string JottoFeedback::FormatClue(Pattern pattern, size_t)
+{
+    return std::to_string(pattern);
+}
+
+/// Returns the number of positions where secret and guess have the same letter
+Pattern GreensFeedback::Compute(std::string_view secret, std::string_view guess) noexcept
+{
+    Pattern greens = 0;
+    for (size_t i = 0; i < guess.length(); ++i)
+        greens = static_cast<Pattern>(greens + (guess[i] == secret[i]));
+
+    return greens;
+}
+
+/// Compute the pattern of guess against every word in the store
+void GreensFeedback::ComputeRow(const WordColumns& columns, std::string_view guess,
+    std::span<Pattern> row)
+{
+    const size_t n  = columns.GetWordCount();
+    const size_t ws = columns.GetWordSize();
+
+    std::fill(row.begin(), row.end(), Pattern(0));
+    Pattern* r = row.data();
+    for (size_t p = 0; p < ws; ++p) {
+        const uint8_t* col = columns.GetColumn(p).data();
+        const auto g = static_cast<uint8_t>(guess[p]);
+        for (size_t s = 0; s < n; ++s)
+            r[s] = static_cast<Pattern>(r[s] + (col[s] == g));
+    }
+}
+
+static_assert(FeedbackModel<WordleFeedback>);
+static_assert(FeedbackModel<JottoFeedback>);
+static_assert(FeedbackModel<GreensFeedback>);
+
+/// Returns the name of a feedback model
+std::string_view GetFeedbackName(const AnyFeedback& feedback) noexcept
+{
+    return std::visit([](const auto& f) { return std::string_view(f.name); }, feedback);
+}
+
+/// Look up a feedback model by name; returns false if there's no such model
+bool ParseFeedback(std::string_view name, AnyFeedback& feedback)
+{
+    return [&]<size_t... I>(std::index_sequence<I...>) {
+        return ((std::variant_alternative_t<I, AnyFeedback>::name == name ?
+            (feedback.emplace<I>(), true) : false) || ...);
+    }(std::make_index_sequence<std::variant_size_v<AnyFeedback>>());
+}
+
+/// Returns the number of distinct patterns a model gives for a word size
+size_t GetPatternCount(const AnyFeedback& feedback, size_t word_size) noexcept
+{
+    return std::visit([word_size](const auto& f) { return f.GetPatternCount(word_size); }, feedback);
+}
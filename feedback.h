@@ -0,0 +1,218 @@
+/**
+ * @file    feedback.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares feedback patterns; the clue for a guess as a number
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef feedback__header_included
+#define feedback__header_included
+
+#include <string_view>
+#include <concepts>
+#include <cstdint>
+#include <utility>
+#include <variant>
+#include <string>
+#include <vector>
+#include <span>
+
+#include "word_columns.h"
+
+class HintConstraints;
+class HintMatcher;
+
+/**
+ * @brief The clue for a guess encoded as a base 3 number
+ *
+ * Digit i (least significant first) is the result for letter i of the
+ * guess: 0 if it's missing, 1 if it's mislaid, and 2 if it's matched.
+ */
+using Pattern = uint16_t;
+
+/// Longest word that fits in a Pattern
+constexpr size_t max_pattern_word_size = 10;
+
+/// Pattern digits
+constexpr Pattern pattern_missing = 0;
+constexpr Pattern pattern_mislaid = 1;
+constexpr Pattern pattern_matched = 2;
+
+/// Returns the number of distinct patterns for the given word size
+constexpr size_t GetPatternCount(size_t word_size) noexcept
+{
+    size_t count = 1;
+    while (word_size--)
+        count *= 3;
+    return count;
+}
+
+/// Returns the pattern for a guess; same rules as mrdle::CheckWordGuess
+Pattern ComputePattern(std::string_view secret, std::string_view guess) noexcept;
+
+/// Compute the pattern of guess against every word in the store
+void ComputePatternRow(const WordColumns& columns, std::string_view guess,
+    std::span<Pattern> row);
+
+/// Returns the result string (mrdle::res_* characters) for a pattern
+std::string PatternToResult(Pattern pattern, size_t word_size);
+
+/**
+ * @brief Returns the results a result string could stand for
+ *
+ * mrdle::res_any stands for any result, so a result with k of them is 3^k
+ * results with none. A word fits the result if it fits any of them.
+ *
+ * @return Empty if the result isn't valid or is longer than
+ *  max_pattern_word_size
+ */
+std::vector<std::string> GetResultFills(std::string_view result);
+
+/**
+ * @brief Prefilter for models whose clues don't say where letters are;
+ *  it keeps every word, so the Matcher sees them all
+ */
+struct NoPrefilter {
+    using Hint = std::pair<std::string, std::string>;
+
+    bool Compile(std::span<const Hint>, size_t, std::string&) noexcept { return true; }
+    void ApplyMasks(const WordColumns&, std::vector<uint8_t>&) const noexcept {}
+    void ApplyColumns(const WordColumns&, std::vector<uint8_t>&) const noexcept {}
+    bool IsExact() const noexcept { return false; }
+    std::string Describe() const { return {}; }
+};
+
+/**
+ * @brief Matcher for models whose clue is a single pattern; compiling a
+ *  hint computes its row, and a word matches if its pattern is the clue
+ */
+template <typename F>
+class RowMatcher {
+public:
+    bool Compile(const WordColumns& columns, std::string_view guess, std::string_view text)
+    {
+        m_row.resize(columns.GetWordCount());
+        F::ComputeRow(columns, guess, m_row);
+        return F::ParseClue(text, columns.GetWordSize(), m_clue);
+    }
+    bool Matches(size_t w) const noexcept { return m_row[w] == m_clue; }
+
+private:
+    std::vector<Pattern>    m_row;
+    Pattern                 m_clue{0};
+};
+
+/**
+ * @brief A rule for the clue a guess gets, and its pattern code space
+ *
+ * Pattern rows are computed by a loop instantiated for each model, so
+ * nothing is looked up per secret; everything downstream of the rows
+ * (filtering by row, partitions, suggestions, simulations) only compares
+ * and counts patterns, so it's shared by every model.
+ *
+ * - name: what --feedback calls it
+ * - GetPatternCount(word_size): patterns are 0 up to (not including) this
+ * - Compute(secret, guess): the pattern for one secret
+ * - ComputeRow(columns, guess, row): the pattern against every word
+ * - ParseClue(text, word_size, pattern): a clue as given to --hint;
+ *   returns false if it isn't valid
+ * - FormatClue(pattern, word_size): a pattern as --hint takes it
+ * - ValidateClue(text, word_size): true if --hint may give text as a clue
+ *   (which may be looser than a single pattern)
+ * - Matcher: one hint compiled for testing words one at a time
+ *   (Compile(columns, guess, text), false if no word fits it, and
+ *   Matches(w)), so that every hint is tested in one pass over the words;
+ *   RowMatcher if the only test is the pattern row
+ * - Prefilter: compiles every hint at once into letter masks and column
+ *   domains (Compile, ApplyMasks, ApplyColumns, IsExact, Describe) that
+ *   narrow the words before the Matcher, which is skipped when the domains
+ *   are exact; NoPrefilter if the clues can't narrow anything that way
+ */
+template <typename F>
+concept FeedbackModel = requires(std::string_view word, size_t word_size,
+    const WordColumns& columns, std::span<Pattern> row, Pattern& pattern)
+{
+    { F::name } -> std::convertible_to<std::string_view>;
+    { F::GetPatternCount(word_size) } -> std::same_as<size_t>;
+    { F::Compute(word, word) } -> std::same_as<Pattern>;
+    F::ComputeRow(columns, word, row);
+    { F::ParseClue(word, word_size, pattern) } -> std::same_as<bool>;
+    { F::FormatClue(pattern, word_size) } -> std::same_as<std::string>;
+    { F::ValidateClue(word, word_size) } -> std::same_as<bool>;
+    typename F::Matcher;
+    typename F::Prefilter;
+};
+
+/// Wordle: each letter is matched, mislaid or missing (e.g., "!x~xx")
+struct WordleFeedback {
+    static constexpr std::string_view name = "wordle";
+
+    /// Hints merge into the letters each position may hold
+    using Prefilter = HintConstraints;
+    using Matcher   = HintMatcher;
+
+    static constexpr size_t GetPatternCount(size_t word_size) noexcept
+        { return ::GetPatternCount(word_size); }
+    static Pattern Compute(std::string_view secret, std::string_view guess) noexcept
+        { return ComputePattern(secret, guess); }
+    static void ComputeRow(const WordColumns& columns, std::string_view guess,
+        std::span<Pattern> row)
+        { ComputePatternRow(columns, guess, row); }
+    static bool ParseClue(std::string_view text, size_t word_size, Pattern& pattern) noexcept;
+    static std::string FormatClue(Pattern pattern, size_t word_size)
+        { return PatternToResult(pattern, word_size); }
+    static bool ValidateClue(std::string_view text, size_t word_size) noexcept;
+};
+
+/// Jotto: the number of letters the guess and secret have in common,
+/// counting repeated letters as often as both have them (e.g., "2")
+struct JottoFeedback {
+    static constexpr std::string_view name = "jotto";
+
+    using Prefilter = NoPrefilter;
+    using Matcher   = RowMatcher<JottoFeedback>;
+
+    static constexpr size_t GetPatternCount(size_t word_size) noexcept
+        { return word_size + 1; }
+    static Pattern Compute(std::string_view secret, std::string_view guess) noexcept;
+    static void ComputeRow(const WordColumns& columns, std::string_view guess,
+        std::span<Pattern> row);
+    static bool ParseClue(std::string_view text, size_t word_size, Pattern& pattern) noexcept;
+    static std::string FormatClue(Pattern pattern, size_t word_size);
+    static bool ValidateClue(std::string_view text, size_t word_size) noexcept
+        { Pattern pattern; return ParseClue(text, word_size, pattern); }
+};
+
+/// Greens only: the number of letters in the right spot (e.g., "1")
+struct GreensFeedback {
+    static constexpr std::string_view name = "greens";
+
+    using Prefilter = NoPrefilter;
+    using Matcher   = RowMatcher<GreensFeedback>;
+
+    static constexpr size_t GetPatternCount(size_t word_size) noexcept
+        { return word_size + 1; }
+    static Pattern Compute(std::string_view secret, std::string_view guess) noexcept;
+    static void ComputeRow(const WordColumns& columns, std::string_view guess,
+        std::span<Pattern> row);
+    static bool ParseClue(std::string_view text, size_t word_size, Pattern& pattern) noexcept
+        { return JottoFeedback::ParseClue(text, word_size, pattern); }
+    static std::string FormatClue(Pattern pattern, size_t word_size)
+        { return JottoFeedback::FormatClue(pattern, word_size); }
+    static bool ValidateClue(std::string_view text, size_t word_size) noexcept
+        { return JottoFeedback::ValidateClue(text, word_size); }
+};
+
+/// Any of the feedback models; this is the registry. Visiting it once per
+/// row (or per hint) runs the loop instantiated for that model.
+using AnyFeedback = std::variant<WordleFeedback, JottoFeedback, GreensFeedback>;
+
+/// Returns the name of a feedback model
+std::string_view GetFeedbackName(const AnyFeedback& feedback) noexcept;
+/// Look up a feedback model by name; returns false if there's no such model
+bool ParseFeedback(std::string_view name, AnyFeedback& feedback);
+/// Returns the number of distinct patterns a model gives for a word size
+size_t GetPatternCount(const AnyFeedback& feedback, size_t word_size) noexcept;
+
+#endif // ifndef feedback__header_included
@@ -0,0 +1,106 @@
+/**
+ * @file    heuristic.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements HeuristicStrategy's feature cache and weights files
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <algorithm>
+#include <fstream>
+#include <cstdlib>
+#include <cmath>
+
+#include "letter_stats.h"
+#include "heuristic.h"
+#include "util.h"
+
+/// Returns the features for the candidates in state, computing and (while
+/// there is room) caching them
+FeatureCache::FeaturesPtr FeatureCache::Get(const GameState& state, PartitionScorer& scorer)
+{
+    return m_cache.Get(state.candidates, hash_candidates(state.candidates), [&](size_t& bytes) {
+        auto features = std::make_shared<Features>();
+        Compute(state, scorer, *features);
+        bytes = features->size() * sizeof(Features::value_type);
+        return FeaturesPtr(std::move(features));
+    });
+}
+
+/// Compute the features for the candidates in state
+void FeatureCache::Compute(const GameState& state, PartitionScorer& scorer, Features& features)
+{
+    const auto& words = state.dict.GetWords();
+    const size_t ws = words.GetWordSize();
+    const uint32_t word_count = static_cast<uint32_t>(words.size());
+    const double total = static_cast<double>(state.candidates.size());
+
+    // Letter counts among the candidates, by position and anywhere
+    const auto stats = LetterStats::Compute(state.dict.GetColumns(), state.candidates);
+    const auto& at = stats.at;
+    const auto& present = stats.present;
+
+    scorer.Prepare(state);
+    features.resize(word_count);
+    for (uint32_t g = 0; g < word_count; ++g) {
+        const auto word = words[g];
+        uint64_t common = 0;
+        for (size_t p = 0; p < ws; ++p) {
+            if (WordColumns::LetterBit(word[p]))
+                common += at[p * 26 + (word[p] - 'a')];
+        }
+        const auto mask = WordColumns::MakeMask(word);
+        for (int l = 0; l < 26; ++l)
+            common += ((mask >> l) & 1) * present[l];
+
+        features[g] = {
+            static_cast<float>(common / (total * 2 * ws)),
+            static_cast<float>(scorer.GetEntropy(*state.store.GetRow(g), state.candidates)),
+            0.0f};
+    }
+    for (auto c : state.candidates)
+        features[c][2] = static_cast<float>(1 / total);
+}
+
+/// Read weights from a file of "name value" lines
+bool ReadHeuristicWeights(const std::string& path, HeuristicWeights& weights)
+{
+    std::ifstream ifs(path);
+    if (!ifs.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(ifs, line)) {
+        const auto space = line.find(' ');
+        if (space == std::string::npos)
+            continue;
+        const auto name = std::string_view(line).substr(0, space);
+        const auto it = std::ranges::find(heuristic_feature_names, name);
+        if (it == heuristic_feature_names.end())
+            continue;
+
+        char* end = nullptr;
+        const double value = std::strtod(line.c_str() + space + 1, &end);
+        if ((end == line.c_str() + space + 1) || !std::isfinite(value))
+            return false;
+        weights[it - heuristic_feature_names.begin()] = value;
+    }
+
+    return true;
+}
+
+/// Write weights, and the score they got, to a file
+bool WriteHeuristicWeights(const std::string& path, const HeuristicWeights& weights, double score)
+{
+    std::ofstream ofs(path);
+    if (!ofs.is_open())
+        return false;
+
+    for (size_t i = 0; i < heuristic_feature_count; ++i)
+        fmt::print(ofs, "{} {:.6g}\n", heuristic_feature_names[i], weights[i]);
+    fmt::print(ofs, "score {:.6f}\n", score);
+
+    return ofs.good();
+}
@@ -0,0 +1,131 @@
+/**
+ * @file    heuristic.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares HeuristicStrategy, a weighted sum of guess features
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef heuristic__header_included
+#define heuristic__header_included
+
+#include <string_view>
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <vector>
+#include <array>
+
+#include "keyed_cache.h"
+#include "strategy.h"
+
+/// Features a heuristic scores each guess on
+constexpr size_t heuristic_feature_count = 3;
+/// Weight of each feature, in the order of heuristic_feature_names
+using HeuristicWeights = std::array<double, heuristic_feature_count>;
+/// Feature names, as used in weights files
+constexpr std::array<std::string_view, heuristic_feature_count> heuristic_feature_names = {
+    "frequency",    ///< Letters common among candidates, by position and anywhere; 0..1
+    "entropy",      ///< Bits of information the guess's clue gives
+    "win",          ///< Chance that the guess is the answer
+};
+/// Weights found by --tune over the built-in word list
+constexpr HeuristicWeights default_heuristic_weights = {0.25, 1.0, 0.5};
+
+/**
+ * @brief Features of every guess for a set of candidates, shared by threads
+ *  and kept across simulations
+ *
+ * Features depend only on the candidates, not on the weights, so every
+ * simulation with the same opener revisits the same states whatever the
+ * weights; tuning scores most weight vectors with nothing but dot products.
+ * The earliest (first and second turn) states are the ones that every game
+ * passes through, and they're the ones cached first.
+ */
+class FeatureCache {
+public:
+
+    /// Features of each guess (by word index)
+    using Features    = std::vector<std::array<float, heuristic_feature_count>>;
+    using FeaturesPtr = std::shared_ptr<const Features>;
+    using Stats       = KeyedCache<std::vector<uint32_t>, Features>::Stats;
+
+    static constexpr size_t default_bytes = size_t(256) << 20;
+
+    // -- Construction
+
+    explicit FeatureCache(size_t max_bytes) : m_cache(max_bytes) {}
+
+    // -- Methods
+
+    /// Returns the features for the candidates in state, computing and
+    /// (while there is room) caching them
+    FeaturesPtr Get(const GameState& state, PartitionScorer& scorer);
+    /// Compute the features for the candidates in state
+    static void Compute(const GameState& state, PartitionScorer& scorer, Features& features);
+
+    /// Change the size of the cache, discarding entries that no longer fit
+    void SetLimit(size_t bytes) { m_cache.SetLimit(bytes); }
+    /// Discard every entry
+    void Clear() { m_cache.Clear(); }
+    /// Returns cache statistics
+    Stats GetStats() const { return m_cache.GetStats(); }
+
+private:
+
+    KeyedCache<std::vector<uint32_t>, Features>  m_cache;    ///< By candidates
+};
+
+/// Guess from the whole word list with the highest weighted sum of features
+class HeuristicStrategy {
+public:
+    static constexpr std::string_view name = "heuristic";
+    static constexpr bool fixed_opener = true;
+
+    HeuristicStrategy() = default;
+    explicit HeuristicStrategy(const HeuristicWeights& weights,
+        std::shared_ptr<FeatureCache> cache = nullptr)
+        : m_weights(weights), m_cache(std::move(cache)) {}
+
+    uint32_t Choose(const GameState& state, RandomStream&)
+    {
+        const FeatureCache::Features* features = &m_features;
+        FeatureCache::FeaturesPtr cached;
+        if (m_cache)
+            features = (cached = m_cache->Get(state, m_scorer)).get();
+        else
+            FeatureCache::Compute(state, m_scorer, m_features);
+
+        return m_scorer.ChooseBest(state, IndexRange{static_cast<uint32_t>(state.dict.GetWordCount())},
+            [&](uint32_t g) {
+                const auto& f = (*features)[g];
+                double score = 0;
+                for (size_t i = 0; i < heuristic_feature_count; ++i)
+                    score += m_weights[i] * f[i];
+                return score;
+            });
+    }
+
+    const HeuristicWeights& GetWeights() const noexcept { return m_weights; }
+    void SetWeights(const HeuristicWeights& weights) noexcept { m_weights = weights; }
+
+private:
+    HeuristicWeights                m_weights{default_heuristic_weights};
+    std::shared_ptr<FeatureCache>   m_cache;        ///< Shared by copies; may be null
+    PartitionScorer                 m_scorer;
+    FeatureCache::Features          m_features;     ///< When there's no cache
+};
+
+/**
+ * @brief Read weights from a file of "name value" lines
+ *
+ * Features the file doesn't name keep their weights; other lines (such as
+ * the score that --tune writes) are ignored.
+ *
+ * @return False if the file can't be read or a weight isn't a number
+ */
+bool ReadHeuristicWeights(const std::string& path, HeuristicWeights& weights);
+/// Write weights, and the score they got, to a file
+bool WriteHeuristicWeights(const std::string& path, const HeuristicWeights& weights, double score);
+
+#endif // ifndef heuristic__header_included
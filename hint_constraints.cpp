@@ -0,0 +1,319 @@
+/**
+ * @file    hint_constraints.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements HintConstraints; a set of hints merged into letter domains
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <fmt/format.h>
+#include <array>
+#include <bit>
+#include <set>
+
+#include "hint_constraints.h"
+#include "feedback.h"
+#include "mrdle.h"
+
+/// Returns the letter for a mask with a single letter bit
+static char MaskLetter(WordColumns::LetterMask mask) noexcept
+{
+    return static_cast<char>('a' + std::countr_zero(mask));
+}
+
+/// Returns the letters in a mask, in order
+static std::string MaskLetters(WordColumns::LetterMask mask)
+{
+    std::string letters;
+    for (; mask; mask &= mask - 1)
+        letters += MaskLetter(mask);
+    return letters;
+}
+
+/// Merge hints and propagate; returns false if no word can satisfy them all
+bool HintConstraints::Compile(std::span<const Hint> hints, size_t word_size, std::string& error)
+{
+    const State empty{std::vector<LetterMask>(word_size, all_letters | others_bit), 0};
+    const auto describe = [](const Hint& h) { return fmt::format("{} {}", h.first, h.second); };
+
+    m_state = empty;
+    m_exact = true;
+    for (size_t k = 0; k < hints.size(); ++k) {
+        for (char ch : hints[k].first)
+            m_exact &= (WordColumns::LetterBit(ch) != 0);
+        m_exact &= (hints[k].second.find(mrdle::res_any) == std::string::npos);
+
+        AddHint(m_state, hints[k]);
+        std::string reason;
+        if (Propagate(m_state, reason))
+            continue;
+
+        // This hint broke it; find the earliest hint it conflicts with on
+        // its own, if there is one
+        State alone = empty;
+        AddHint(alone, hints[k]);
+        if (!Propagate(alone, reason)) {
+            error = fmt::format("{} contradicts itself ({})", describe(hints[k]), reason);
+            return false;
+        }
+        for (size_t j = 0; j < k; ++j) {
+            State pair = empty;
+            AddHint(pair, hints[j]);
+            AddHint(pair, hints[k]);
+            if (!Propagate(pair, reason)) {
+                error = fmt::format("{} conflicts with {} ({})",
+                    describe(hints[k]), describe(hints[j]), reason);
+                return false;
+            }
+        }
+        Propagate(m_state, reason);
+        error = fmt::format("{} conflicts with the hints before it ({})", describe(hints[k]), reason);
+        return false;
+    }
+
+    return true;
+}
+
+/// Narrow a state by one hint
+void HintConstraints::AddHint(State& state, const Hint& hint)
+{
+    const auto& [hword, hres] = hint;
+    for (size_t i = 0; i < hword.length(); ++i) {
+        const auto bit = WordColumns::LetterBit(hword[i]);
+        switch (hres[i]) {
+        case mrdle::res_matched:
+            state.allowed[i] &= bit ? bit : others_bit;
+            break;
+        case mrdle::res_mislaid:
+            state.allowed[i] &= ~bit;
+            state.required |= bit;
+            break;
+        case mrdle::res_missing:
+            // Not anywhere the hint didn't match it. An unknown result may
+            // be a match, but only of the letter guessed there.
+            for (size_t c = 0; c < hword.length(); ++c) {
+                const bool may_match = (hres[c] == mrdle::res_matched) ||
+                    ((hres[c] == mrdle::res_any) && (hword[c] == hword[i]));
+                if (!may_match)
+                    state.allowed[c] &= ~bit;
+            }
+            break;
+        default: break;
+        }
+    }
+}
+
+/// Derive what the state implies; returns false, with the reason, if it
+/// can't be satisfied
+bool HintConstraints::Propagate(State& state, std::string& reason)
+{
+    const auto is_fixed = [](LetterMask a) { return std::has_single_bit(a) && !(a & others_bit); };
+
+    for (bool changed = true; changed; ) {
+        changed = false;
+
+        LetterMask placed = 0;
+        size_t open = 0;
+        for (size_t p = 0; p < state.allowed.size(); ++p) {
+            const LetterMask a = state.allowed[p];
+            if (!a) {
+                reason = fmt::format("nothing fits position {}", p + 1);
+                return false;
+            }
+            if (is_fixed(a))
+                placed |= a;
+            else
+                ++open;
+        }
+
+        // A required letter allowed at only one open position must be there
+        const LetterMask unplaced = state.required & ~placed;
+        for (LetterMask rest = unplaced; rest; rest &= rest - 1) {
+            const LetterMask bit = rest & -rest;
+            size_t count = 0, where = 0;
+            for (size_t p = 0; p < state.allowed.size(); ++p) {
+                if (state.allowed[p] & bit) {
+                    ++count;
+                    where = p;
+                }
+            }
+            if (0 == count) {
+                reason = fmt::format("'{}' must be in the word but fits nowhere", MaskLetter(bit));
+                return false;
+            }
+            if (1 == count) {
+                state.allowed[where] = bit;
+                changed = true;
+            }
+        }
+        if (changed)
+            continue;
+
+        // Required letters that just fill the open positions leave no room
+        // for anything else
+        const size_t needed = static_cast<size_t>(std::popcount(unplaced));
+        if (needed > open) {
+            reason = fmt::format("{} must all be in the word but only {} position{} {} open",
+                MaskLetters(unplaced), open, (open == 1) ? "" : "s", (open == 1) ? "is" : "are");
+            return false;
+        }
+        if (needed && (needed == open)) {
+            for (auto& a : state.allowed) {
+                if (!is_fixed(a) && (a & ~unplaced)) {
+                    a &= unplaced;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/// Returns the letters no word may have
+HintConstraints::LetterMask HintConstraints::GetForbidden() const noexcept
+{
+    LetterMask anywhere = 0;
+    for (auto a : m_state.allowed)
+        anywhere |= a;
+    return all_letters & ~anywhere;
+}
+
+/// Clear keep[w] for words missing a required letter or having one that's
+/// allowed nowhere
+void HintConstraints::ApplyMasks(const WordColumns& columns, std::vector<uint8_t>& keep) const
+{
+    const LetterMask forbidden = GetForbidden();
+    if (m_state.required || forbidden)
+        columns.KeepIfMask(m_state.required, forbidden, keep);
+}
+
+/// Clear keep[w] for words with a letter that isn't allowed where it is
+void HintConstraints::ApplyColumns(const WordColumns& columns, std::vector<uint8_t>& keep) const
+{
+    // Letters allowed nowhere are already gone, so a position only needs a
+    // scan if it rules out something more
+    const LetterMask forbidden = GetForbidden();
+    for (size_t p = 0; p < m_state.allowed.size(); ++p) {
+        const LetterMask a = m_state.allowed[p];
+        if ((a | forbidden) == (all_letters | others_bit))
+            continue;
+        if (std::has_single_bit(a) && !(a & others_bit))
+            columns.KeepIfLetterAt(p, MaskLetter(a), keep);
+        else
+            columns.KeepIfLetterIn(p, a & all_letters, (a & others_bit) != 0, keep);
+    }
+}
+
+/// Returns a human readable description of the domains
+std::string HintConstraints::Describe() const
+{
+    std::string out = "Hint constraints:\n";
+    for (size_t p = 0; p < m_state.allowed.size(); ++p) {
+        const LetterMask a = m_state.allowed[p];
+        const LetterMask letters = a & all_letters;
+        std::string domain;
+        if (a == (all_letters | others_bit))
+            domain = "any";
+        else if (std::has_single_bit(a) && !(a & others_bit))
+            domain = MaskLetters(a);
+        else if (std::popcount(letters) <= 13)
+            domain = fmt::format("[{}]", MaskLetters(letters));
+        else
+            domain = fmt::format("[^{}]", MaskLetters(all_letters & ~letters));
+        out += fmt::format("  position {}: {}\n", p + 1, domain);
+    }
+    if (m_state.required)
+        out += fmt::format("  required:   {}\n", MaskLetters(m_state.required));
+    if (const auto forbidden = GetForbidden())
+        out += fmt::format("  forbidden:  {}\n", MaskLetters(forbidden));
+    if (!m_exact)
+        out += "  (not exact; survivors are checked against every hint)\n";
+
+    return out;
+}
+
+/// Compile a valid hint for the words in columns
+bool HintMatcher::Compile(const WordColumns& columns, std::string_view guess,
+    std::string_view result)
+{
+    const size_t ws = columns.GetWordSize();
+    m_guess = guess;
+    m_masks = columns.GetMasks();
+    m_cols.resize(ws);
+    for (size_t p = 0; p < ws; ++p)
+        m_cols[p] = columns.GetColumn(p).data();
+
+    const bool unknowns = (result.find(mrdle::res_any) != result.npos);
+    const auto fills = unknowns ? GetResultFills(result) :
+        std::vector<std::string>{std::string(result)};
+
+    // Results that tell the word apart the same way are kept once
+    std::set<Domains> unique;
+    for (const auto& fill : fills) {
+        const HintConstraints::Hint hint{m_guess, fill};
+        HintConstraints hc;
+        std::string error;
+        if (!hc.Compile(std::span(&hint, 1), ws, error))
+            continue;       // No word gives this result
+        Domains d;
+        d.required = hc.GetRequired();
+        d.forbidden = hc.GetForbidden();
+        for (size_t p = 0; p < ws; ++p)
+            d.allowed.push_back(hc.GetAllowed(p));
+        d.exact = hc.IsExact();
+        if (!d.exact)
+            d.result = fill;
+        unique.insert(std::move(d));
+    }
+    m_domains.assign(unique.begin(), unique.end());
+
+    m_patterns.clear();
+    if (m_domains.size() > 1) {
+        m_patterns.assign(GetPatternCount(ws), 0);
+        for (const auto& fill : fills) {
+            Pattern pattern;
+            if (WordleFeedback::ParseClue(fill, ws, pattern))
+                m_patterns[pattern] = 1;
+        }
+    }
+
+    return !m_domains.empty();
+}
+
+/// Returns true if word w satisfies the hint
+bool HintMatcher::Matches(size_t w) const
+{
+    if (!m_patterns.empty()) {
+        std::array<char, max_pattern_word_size> word;
+        for (size_t p = 0; p < m_cols.size(); ++p)
+            word[p] = static_cast<char>(m_cols[p][w]);
+        if (m_patterns[ComputePattern(std::string_view(word.data(), m_cols.size()), m_guess)])
+            return true;
+    }
+
+    for (const auto& d : m_domains) {
+        if (InDomains(d, w))
+            return true;
+    }
+    return false;
+}
+
+/// Returns true if word w is in the domains
+bool HintMatcher::InDomains(const Domains& d, size_t w) const
+{
+    const LetterMask mask = m_masks[w];
+    if (((mask & d.required) != d.required) || (mask & d.forbidden))
+        return false;
+    for (size_t p = 0; p < m_cols.size(); ++p) {
+        if (!(d.allowed[p] & HintConstraints::GetCharBit(static_cast<char>(m_cols[p][w]))))
+            return false;
+    }
+    if (d.exact)
+        return true;
+
+    std::string word(m_cols.size(), ' ');
+    for (size_t p = 0; p < m_cols.size(); ++p)
+        word[p] = static_cast<char>(m_cols[p][w]);
+    return mrdle::CheckWordAgainstHint(word, {m_guess, d.result});
+}
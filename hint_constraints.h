@@ -0,0 +1,164 @@
+/**
+ * @file    hint_constraints.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares HintConstraints; a set of hints merged into letter domains
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef hint_constraints__header_included
+#define hint_constraints__header_included
+
+#include <string_view>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <string>
+#include <span>
+
+#include "word_columns.h"
+
+/**
+ * @brief Hints merged into what each position may hold and which letters
+ *  the word must have
+ *
+ * Each hint narrows the letters allowed at each position (a match fixes
+ * one; a mislaid letter is ruled out where it was guessed; a missing
+ * letter is ruled out everywhere the hint didn't match) and may require
+ * letters. Propagation then derives what follows:
+ *  - A required letter allowed at only one position must be there.
+ *  - When the required letters not yet placed just fill the open
+ *    positions, nothing else may go in them.
+ * A position with nothing allowed, a required letter with nowhere to go,
+ * or more letters required than there are open positions means no word
+ * can satisfy the hints. All of this works on letter masks per position,
+ * so it takes the same time however long the word list is.
+ *
+ * A hint's unknown results (mrdle::res_any) add nothing but what holds
+ * whatever they are. For hints made of letters (a..z) with no unknown
+ * results the domains are exact: a word
+ * satisfies every hint if and only if it has every required letter and
+ * an allowed letter at each position, so they replace the per-word check.
+ */
+class HintConstraints {
+public:
+
+    using LetterMask = WordColumns::LetterMask;
+    /// A guessed word and its result string (mrdle::res_* characters)
+    using Hint = std::pair<std::string, std::string>;
+
+    // -- Methods
+
+    /**
+     * @brief Merge hints and propagate; returns false if no word can
+     *  satisfy them all
+     *
+     * Hints must already be valid for the word size. On a conflict, error
+     * names the hint, or pair of hints, responsible and why.
+     */
+    bool Compile(std::span<const Hint> hints, size_t word_size, std::string& error);
+
+    /// Clear keep[w] for words missing a required letter or having one
+    /// that's allowed nowhere
+    void ApplyMasks(const WordColumns& columns, std::vector<uint8_t>& keep) const;
+    /// Clear keep[w] for words with a letter that isn't allowed where it is
+    void ApplyColumns(const WordColumns& columns, std::vector<uint8_t>& keep) const;
+
+    /// Returns true if the domains say all the hints do (see above);
+    /// otherwise the survivors of Apply* must still be checked
+    bool IsExact() const noexcept { return m_exact; }
+
+    /// Returns true if ch may be at pos
+    bool IsAllowed(size_t pos, char ch) const noexcept
+        { return (m_state.allowed[pos] & GetCharBit(ch)) != 0; }
+    /// Returns what may be at pos, as GetCharBit bits
+    LetterMask GetAllowed(size_t pos) const noexcept { return m_state.allowed[pos]; }
+    /// Returns the bit for ch in an allowed mask; characters that aren't
+    /// letters (a..z) share one
+    static constexpr LetterMask GetCharBit(char ch) noexcept
+    {
+        const auto bit = WordColumns::LetterBit(ch);
+        return bit ? bit : others_bit;
+    }
+    /// Returns the letters every word must have
+    LetterMask GetRequired() const noexcept { return m_state.required; }
+    /// Returns the letters no word may have
+    LetterMask GetForbidden() const noexcept;
+
+    /// Returns a human readable description of the domains
+    std::string Describe() const;
+
+private:
+
+    /// Bit for characters that aren't letters (a..z) in an allowed mask
+    static constexpr LetterMask others_bit = LetterMask(1) << 26;
+    static constexpr LetterMask all_letters = others_bit - 1;
+
+    struct State {
+        std::vector<LetterMask> allowed;    ///< Per position; letters plus others_bit
+        LetterMask              required{0};
+    };
+
+    /// Narrow a state by one hint
+    static void AddHint(State& state, const Hint& hint);
+    /// Derive what the state implies; returns false, with the reason, if
+    /// it can't be satisfied
+    static bool Propagate(State& state, std::string& reason);
+
+    State   m_state;
+    bool    m_exact{true};
+};
+
+/**
+ * @brief One hint compiled for testing words one at a time, so that many
+ *  hints are checked in a single pass over the words
+ *
+ * A result with unknowns (mrdle::res_any) stands for every result it could
+ * be, and a word satisfies it if it satisfies any of them. Each of those
+ * that some word could satisfy is compiled once, by HintConstraints, into
+ * its required and forbidden letters and what each position allows, and
+ * alike domains are kept once; testing a word is two mask operations and
+ * a lookup per position for each. A word always satisfies the result it
+ * would actually give, so with more than one domain that result is looked
+ * up first. Domains that aren't exact are followed by the per-word check.
+ */
+class HintMatcher {
+public:
+
+    using LetterMask = WordColumns::LetterMask;
+
+    // -- Methods
+
+    /// Compile a valid hint for the words in columns, which must outlive
+    /// this; returns false if no word can satisfy it
+    bool Compile(const WordColumns& columns, std::string_view guess, std::string_view result);
+
+    /// Returns true if word w satisfies the hint
+    bool Matches(size_t w) const;
+
+    /// Returns the number of distinct domains the hint compiled into
+    size_t GetDomainCount() const noexcept { return m_domains.size(); }
+
+private:
+
+    struct Domains {
+        LetterMask              required{0};
+        LetterMask              forbidden{0};
+        std::vector<LetterMask> allowed;        ///< By position; GetCharBit bits
+        std::string             result;         ///< Checked per word unless exact
+        bool                    exact{true};
+
+        auto operator<=>(const Domains&) const = default;
+    };
+
+    /// Returns true if word w is in the domains
+    bool InDomains(const Domains& d, size_t w) const;
+
+    std::vector<Domains>            m_domains;
+    std::vector<uint8_t>            m_patterns;     ///< By pattern: 1 if the result could be it
+    std::vector<const uint8_t*>     m_cols;         ///< Letter columns by position
+    std::span<const LetterMask>     m_masks;        ///< Letter mask by word
+    std::string                     m_guess;
+};
+
+#endif // ifndef hint_constraints__header_included
@@ -0,0 +1,174 @@
+/**
+ * @file    keyed_cache.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares KeyedCache; values shared by threads, keyed by a sequence
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef keyed_cache__header_included
+#define keyed_cache__header_included
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <array>
+#include <mutex>
+#include <span>
+
+/**
+ * @brief Values computed from a key (such as a candidate list, or the
+ *  text of a request), shared by threads
+ *
+ * Entries are filed under a hash of the key that the caller supplies and
+ * matched by comparing the whole key, split over shards so that threads
+ * rarely wait on each other. Entries are kept until a shard is full; the
+ * ones that come first are usually the ones asked for most. Values are
+ * only good for what they were computed over; callers clear the cache
+ * when that changes.
+ *
+ * @tparam Key      Stored key; a contiguous range (std::vector, std::string)
+ * @tparam Value    Cached value, handed out as shared_ptr<const Value>
+ */
+template <typename Key, typename Value>
+class KeyedCache {
+public:
+
+    using Element  = typename Key::value_type;
+    using ValuePtr = std::shared_ptr<const Value>;
+
+    /// Cache statistics
+    struct Stats {
+        size_t  hits{0};            ///< Keys found in the cache
+        size_t  computes{0};        ///< Values computed
+        size_t  entries{0};         ///< Keys in the cache
+        size_t  bytes{0};           ///< Bytes used by the cache
+    };
+
+    // -- Construction
+
+    explicit KeyedCache(size_t max_bytes) : m_limit(max_bytes / shard_count) {}
+
+    // -- Methods
+
+    /// Returns the cached value for key, or null
+    ValuePtr Find(std::span<const Element> key, uint64_t hash)
+    {
+        Shard& shard = m_shards[hash % shard_count];
+        std::lock_guard lock(shard.lock);
+        auto value = shard.Find(key, hash);
+        if (value)
+            ++shard.stats.hits;
+        return value;
+    }
+
+    /**
+     * @brief Cache a value computed for key, while there is room
+     *
+     * @param bytes What the value takes, not counting the key
+     * @return The value in the cache; another thread may have put one
+     *  there first
+     */
+    ValuePtr Insert(std::span<const Element> key, uint64_t hash, ValuePtr value, size_t bytes)
+    {
+        Shard& shard = m_shards[hash % shard_count];
+        std::lock_guard lock(shard.lock);
+        ++shard.stats.computes;
+        if (auto existing = shard.Find(key, hash))
+            return existing;
+        bytes += key.size_bytes();
+        if (shard.bytes + bytes <= m_limit) {
+            shard.entries.emplace(hash, Entry{Key(key.begin(), key.end()), value});
+            shard.bytes += bytes;
+        }
+        return value;
+    }
+
+    /**
+     * @brief Returns the value for key, computing and (while there is
+     *  room) caching it
+     *
+     * @param compute Called as compute(bytes) without a lock held; returns
+     *  the value and sets bytes to what it takes
+     */
+    template <typename Compute>
+    ValuePtr Get(std::span<const Element> key, uint64_t hash, Compute&& compute)
+    {
+        if (auto value = Find(key, hash))
+            return value;
+        size_t bytes = 0;
+        ValuePtr value = compute(bytes);
+        return Insert(key, hash, std::move(value), bytes);
+    }
+
+    /// Change the size of the cache, discarding shards that no longer fit
+    void SetLimit(size_t bytes)
+    {
+        m_limit = bytes / shard_count;
+        for (auto& shard : m_shards) {
+            std::lock_guard lock(shard.lock);
+            if (shard.bytes > m_limit) {
+                shard.entries.clear();
+                shard.bytes = 0;
+            }
+        }
+    }
+
+    /// Discard every entry
+    void Clear()
+    {
+        for (auto& shard : m_shards) {
+            std::lock_guard lock(shard.lock);
+            shard.entries.clear();
+            shard.bytes = 0;
+        }
+    }
+
+    /// Returns cache statistics
+    Stats GetStats() const
+    {
+        Stats total;
+        for (const auto& shard : m_shards) {
+            std::lock_guard lock(shard.lock);
+            total.hits     += shard.stats.hits;
+            total.computes += shard.stats.computes;
+            total.entries  += shard.entries.size();
+            total.bytes    += shard.bytes;
+        }
+        return total;
+    }
+
+private:
+
+    struct Entry {
+        Key         key;
+        ValuePtr    value;
+    };
+
+    struct Shard {
+        mutable std::mutex                          lock;
+        std::unordered_multimap<uint64_t, Entry>    entries;    ///< By key hash
+        size_t                                      bytes{0};
+        Stats                                       stats;
+
+        /// Returns the value for key, or null; lock must be held
+        ValuePtr Find(std::span<const Element> key, uint64_t hash) const
+        {
+            auto [first, last] = entries.equal_range(hash);
+            for (auto it = first; it != last; ++it) {
+                if (std::ranges::equal(it->second.key, key))
+                    return it->second.value;
+            }
+            return nullptr;
+        }
+    };
+
+    static constexpr size_t shard_count = 16;
+
+    std::atomic<size_t>                 m_limit;            ///< Bytes per shard
+    std::array<Shard, shard_count>      m_shards;
+};
+
+#endif // ifndef keyed_cache__header_included
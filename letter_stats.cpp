@@ -0,0 +1,103 @@
+/**
+ * @file    letter_stats.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements LetterStats; letter frequencies over a set of candidates
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <fmt/format.h>
+#include <algorithm>
+
+#include "letter_stats.h"
+
+/// Count letters over the candidates (indexes into columns)
+LetterStats LetterStats::Compute(const WordColumns& columns, std::span<const uint32_t> candidates)
+{
+    const size_t ws = columns.GetWordSize();
+    LetterStats stats;
+    stats.word_size = ws;
+    stats.words = candidates.size();
+    stats.at.assign(ws * 26, 0);
+
+    if (candidates.size() == columns.GetWordCount()) {
+        // Every word; the dictionary already has the counts
+        for (size_t p = 0; p < ws; ++p) {
+            for (size_t l = 0; l < 26; ++l)
+                stats.at[p * 26 + l] = static_cast<uint32_t>(columns.GetLetterCount(p, char('a' + l)));
+        }
+        for (size_t l = 0; l < 26; ++l)
+            stats.present[l] = static_cast<uint32_t>(columns.GetPresenceCount(char('a' + l)));
+    }
+    else {
+        std::array<uint32_t, 256> hist;
+        for (size_t p = 0; p < ws; ++p) {
+            hist.fill(0);
+            const uint8_t* col = columns.GetColumn(p).data();
+            for (auto c : candidates)
+                ++hist[col[c]];
+            std::copy_n(hist.begin() + 'a', 26, stats.at.begin() + p * 26);
+        }
+        const auto masks = columns.GetMasks();
+        for (auto c : candidates) {
+            const auto mask = masks[c];
+            for (size_t l = 0; l < 26; ++l)
+                stats.present[l] += (mask >> l) & 1;
+        }
+    }
+
+    for (size_t p = 0; p < ws; ++p) {
+        for (size_t l = 0; l < 26; ++l)
+            stats.total[l] += stats.at[p * 26 + l];
+    }
+
+    return stats;
+}
+
+/// Returns a table of the letters the candidates have, most common first
+std::string LetterStats::FormatTable() const
+{
+    std::string out = fmt::format("{} candidate{}\n", words, (words == 1) ? "" : "s");
+
+    std::vector<size_t> letters;
+    for (size_t l = 0; l < 26; ++l) {
+        if (present[l])
+            letters.push_back(l);
+    }
+    if (letters.empty())
+        return out;
+    std::stable_sort(letters.begin(), letters.end(),
+        [this](size_t a, size_t b) { return present[a] > present[b]; });
+
+    const size_t width = std::max<size_t>(5, fmt::formatted_size("{}", words));
+    out += fmt::format("{:<6}  {:>{}}  {:>5}  {:>{}}", "letter", "words", width, "%", "total", width);
+    for (size_t p = 0; p < word_size; ++p)
+        out += fmt::format("  {:>{}}", p + 1, width);
+    out += '\n';
+    for (auto l : letters) {
+        out += fmt::format("{:<6}  {:>{}}  {:>5.1f}  {:>{}}", char('a' + l), present[l], width,
+            100.0 * present[l] / words, total[l], width);
+        for (size_t p = 0; p < word_size; ++p)
+            out += fmt::format("  {:>{}}", at[p * 26 + l], width);
+        out += '\n';
+    }
+
+    return out;
+}
+
+/// Returns the counts of every letter as a JSON object
+std::string LetterStats::FormatJson() const
+{
+    std::string out = fmt::format("{{\n  \"candidates\": {},\n  \"word_size\": {},\n  \"letters\": {{\n",
+        words, word_size);
+    for (size_t l = 0; l < 26; ++l) {
+        std::vector<uint32_t> positions(word_size);
+        for (size_t p = 0; p < word_size; ++p)
+            positions[p] = at[p * 26 + l];
+        out += fmt::format("    \"{}\": {{\"words\": {}, \"total\": {}, \"at\": [{}]}}{}\n",
+            char('a' + l), present[l], total[l], fmt::join(positions, ", "), (l < 25) ? "," : "");
+    }
+    out += "  }\n}\n";
+
+    return out;
+}
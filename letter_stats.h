@@ -0,0 +1,54 @@
+/**
+ * @file    letter_stats.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares LetterStats; letter frequencies over a set of candidates
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef letter_stats__header_included
+#define letter_stats__header_included
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <array>
+#include <span>
+
+#include "word_columns.h"
+#include "keyed_cache.h"
+
+/**
+ * @brief Letter counts over a set of candidate words: by position, in
+ *  total, and the number of words that have each letter
+ *
+ * Counting is one pass per position over the word list's letter columns;
+ * every letter byte bumps a 256 entry histogram, so there are no branches
+ * on the letter, and the letter masks give presence. A set of every word
+ * takes the counts gathered when the dictionary was built.
+ */
+struct LetterStats {
+
+    size_t                      word_size{0};
+    size_t                      words{0};       ///< Candidates counted
+    std::vector<uint32_t>       at;             ///< Words with letter L at pos P: [P*26+L]
+    std::array<uint32_t, 26>    total{};        ///< Times letter L appears, at any position
+    std::array<uint32_t, 26>    present{};      ///< Words containing letter L
+
+    /// Count letters over the candidates (distinct indexes into columns)
+    static LetterStats Compute(const WordColumns& columns, std::span<const uint32_t> candidates);
+
+    /// Returns a table of the letters the candidates have, most common first
+    std::string FormatTable() const;
+    /// Returns the counts of every letter as a JSON object
+    std::string FormatJson() const;
+};
+
+/// Letter stats by request: its hints and query in canonical form, so
+/// asking the same thing again (in any order) skips filtering and counting
+using LetterStatsCache = KeyedCache<std::string, LetterStats>;
+
+/// Memory the letter stats cache asks for
+constexpr size_t letter_stats_cache_bytes = size_t(16) << 20;
+
+#endif // ifndef letter_stats__header_included
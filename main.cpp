@@ -11,6 +11,8 @@
 #include <fmt/color.h>
 #include <filesystem>
 #include <stdexcept>
+#include <charconv>
+#include <optional>
 #include <iostream>
 #include <map>
 #include "mrdle.h"
@@ -28,14 +30,50 @@ struct ProgOpts {
     bool                player_stats{false};    ///< --player-stats
     bool                play{true};             ///< --play
     bool                no_color{false};        ///< --no-color
+    bool                timings{false};         ///< --timings
+    bool                batch{false};           ///< --batch
+    bool                suggest{false};         ///< --suggest
+    bool                watch{false};           ///< --watch
+    bool                memory_report{false};   ///< --memory-report
+    bool                tournament{false};      ///< --tournament
+    bool                tune{false};            ///< --tune
+    bool                any_probe{false};       ///< --any-probe
+    bool                find_traps{false};      ///< --find-traps
+    bool                binary{false};          ///< --binary
+    bool                xordle{false};          ///< --xordle
+    bool                explain{false};         ///< --explain
+    bool                explain_words{false};   ///< --explain-words
+    bool                letter_stats{false};    ///< --letter-stats
+    bool                json{false};            ///< --json
 
     std::string         secret_word;            ///< --secret-word
     std::string         word_file;              ///< --word-file
+    std::string         query;                  ///< --query
+    std::string         dict_image;             ///< --dict-image
+    std::string         cache_dir;              ///< --cache-dir
+    std::string         memory_budget;          ///< --memory-budget
+    std::string         seed;                   ///< --seed
+    std::string         strategies;             ///< --strategies
+    std::string         games;                  ///< --games
+    std::string         threads;                ///< --threads
+    std::string         evaluations;            ///< --evaluations
+    std::string         weights;                ///< --weights
+    std::string         output;                 ///< --output
+    std::string         feedback;               ///< --feedback
+
+    size_t              memory_limit{MemoryBudget::unlimited};  ///< Parsed memory_budget
+    std::optional<uint64_t> seed_value;         ///< Parsed seed
+    uint64_t            game_count{0};          ///< Parsed games
+    uint64_t            thread_count{0};        ///< Parsed threads
+    uint64_t            evaluation_count{100};  ///< Parsed evaluations
+    AnyFeedback         feedback_model;         ///< Parsed feedback
 
     mrdle::HintVect     hint_vect;              ///< --hint
+    mrdle::SetOpVect    set_ops;                ///< --union, --intersect, --diff
 };
 
 static int ProcessCommandLine(int argc, char* argv[], ProgOpts& opts);
+static int RunAction(mrdle& ws, const ProgOpts& opts);
 static int DisplayPlayerStats(const ProgOpts& opts);
 static int DisplayVersion(const ProgOpts& opts);
 static int DisplayRules(const ProgOpts& opts);
@@ -58,26 +96,35 @@ int main(int argc, char* argv[])
             return DisplayRules(opts);
         if (opts.player_stats)
             return DisplayPlayerStats(opts);
+        if (!opts.set_ops.empty()) {
+            return mrdle::CombineWordLists(opts.word_file, opts.set_ops, opts.output,
+                opts.binary, opts.timings);
+        }
 
         // Instantiate the mrdle object
-        mrdle ws(opts.word_file);
+        mrdle ws(opts.word_file, opts.dict_image, opts.cache_dir, opts.memory_limit);
         if (0 == ws.GetWordListCount()) {
             // Something failed; should have been reported
             return 1;
         }
         ws.SetNoColorMode(opts.no_color);
-
-        if (opts.list)
-            return ws.ListWords(opts.hint_vect);
-
-        // Validate secret word length if necessary
-        auto swl = opts.secret_word.length();
-        if (swl && swl != ws.GetWordSize()) {
-            fmt::print(std::cerr, "mrdle: Invalid secret word length\n");
-            return 1;
+        ws.SetTimingsMode(opts.timings);
+        ws.SetFeedback(opts.feedback_model);
+        if (opts.explain || opts.explain_words)
+            ws.SetExplainMode(opts.explain_words ? mrdle::Explain::Words : mrdle::Explain::Counts);
+        if (opts.letter_stats) {
+            ws.SetLetterStatsMode(opts.json ?
+                mrdle::LetterStatsMode::Json : mrdle::LetterStatsMode::Table);
         }
-
-        ws.TerminalPlay(opts.secret_word);
+        if (opts.seed_value)
+            ws.SetSeed(*opts.seed_value);
+        if (opts.watch)
+            ws.EnableAutoReload();
+
+        const int ret = RunAction(ws, opts);
+        if (opts.memory_report)
+            fmt::print(std::cerr, "{}", ws.GetMemoryBudget().GetReport());
+        return ret;
     }
     catch (std::runtime_error& e) {
         fmt::print(std::cerr, "Well this is emabarrassing: {}\n", e.what());
@@ -87,6 +134,49 @@ int main(int argc, char* argv[])
     return 0;
 }
 
+int RunAction(mrdle& ws, const ProgOpts& opts)
+{
+    if (opts.batch)
+        return ws.ListWordsBatch(opts.suggest);
+    if (opts.xordle && opts.suggest)
+        return ws.SuggestPairs(opts.hint_vect, opts.query, 10, opts.thread_count);
+    if (opts.xordle)
+        return ws.ListPairs(opts.hint_vect, opts.query);
+    if (opts.suggest)
+        return ws.SuggestWords(opts.hint_vect, opts.query);
+    if (opts.find_traps)
+        return ws.FindTraps();
+    if (opts.any_probe)
+        return ws.FindAnyProbe(opts.hint_vect, opts.query, opts.thread_count);
+    if (opts.tune)
+        return ws.TuneWeights(opts.game_count, opts.thread_count, opts.evaluation_count, opts.weights);
+    if (!opts.weights.empty() && !ws.LoadHeuristicWeights(opts.weights))
+        return 1;
+    if (opts.tournament)
+        return ws.RunTournament(opts.strategies, opts.game_count, opts.thread_count);
+
+    if (opts.list)
+        return ws.ListWords(opts.hint_vect, opts.query);
+
+    // Validate secret word length if necessary
+    auto swl = opts.secret_word.length();
+    if (swl && swl != ws.GetWordSize()) {
+        fmt::print(std::cerr, "mrdle: Invalid secret word length\n");
+        return 1;
+    }
+
+    ws.TerminalPlay(opts.secret_word);
+    return 0;
+}
+
+/// Parse a whole string as an unsigned number
+static bool ParseNumber(std::string_view text, uint64_t& value)
+{
+    const auto* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    return (ec == std::errc()) && (ptr == end) && !text.empty();
+}
+
 int ProcessCommandLine(int argc, char* argv[], ProgOpts& opts)
 {
     // Quick and dirty implementation. Not using getopt because it's not
@@ -101,10 +191,42 @@ int ProcessCommandLine(int argc, char* argv[], ProgOpts& opts)
     bool_map["player-stats"] = &opts.player_stats;
     bool_map["play"]         = &opts.play;
     bool_map["no-color"]     = &opts.no_color;
+    bool_map["timings"]      = &opts.timings;
+    bool_map["batch"]        = &opts.batch;
+    bool_map["suggest"]      = &opts.suggest;
+    bool_map["watch"]        = &opts.watch;
+    bool_map["memory-report"] = &opts.memory_report;
+    bool_map["tournament"]   = &opts.tournament;
+    bool_map["tune"]         = &opts.tune;
+    bool_map["any-probe"]    = &opts.any_probe;
+    bool_map["find-traps"]   = &opts.find_traps;
+    bool_map["binary"]       = &opts.binary;
+    bool_map["xordle"]       = &opts.xordle;
+    bool_map["explain"]      = &opts.explain;
+    bool_map["explain-words"] = &opts.explain_words;
+    bool_map["letter-stats"] = &opts.letter_stats;
+    bool_map["json"]         = &opts.json;
     /// Map a "string" argument to its value
     std::map<std::string, std::string*, std::less<>> str_map;
     str_map["secret-word"]   = &opts.secret_word;
     str_map["word-file"]     = &opts.word_file;
+    str_map["query"]         = &opts.query;
+    str_map["dict-image"]    = &opts.dict_image;
+    str_map["cache-dir"]     = &opts.cache_dir;
+    str_map["memory-budget"] = &opts.memory_budget;
+    str_map["seed"]          = &opts.seed;
+    str_map["strategies"]    = &opts.strategies;
+    str_map["games"]         = &opts.games;
+    str_map["threads"]       = &opts.threads;
+    str_map["evaluations"]   = &opts.evaluations;
+    str_map["weights"]       = &opts.weights;
+    str_map["output"]        = &opts.output;
+    str_map["feedback"]      = &opts.feedback;
+    /// Map a set operation argument to its operation
+    std::map<std::string, SetOperation, std::less<>> set_op_map;
+    set_op_map["union"]      = SetOperation::Union;
+    set_op_map["intersect"]  = SetOperation::Intersect;
+    set_op_map["diff"]       = SetOperation::Diff;
 
     // For all command line arguments...
     for (int a=1; a<argc; ++a) {
@@ -138,6 +260,17 @@ int ProcessCommandLine(int argc, char* argv[], ProgOpts& opts)
             continue;
         }
 
+        // Set operations apply in order, so there may be any number of them
+        const auto oit = set_op_map.find(arg);
+        if (oit != set_op_map.cend()) {
+            if (a + 1 >= argc) {
+                fmt::print(std::cerr, "mrdle: Missing required value for argument: {}\n", arg);
+                return -1;
+            }
+            opts.set_ops.emplace_back(oit->second, argv[++a]);
+            continue;
+        }
+
         // Only other valid parameter is --hint which takes two arguments
         if (0 == arg.compare("hint")) {
 
@@ -157,8 +290,49 @@ int ProcessCommandLine(int argc, char* argv[], ProgOpts& opts)
         return -1;
     }
 
+    // Any --query, --explain or --letter-stats implies --list
+    if (!opts.query.empty() || opts.explain || opts.explain_words || opts.letter_stats)
+        opts.list = true;
+
+    if (!opts.memory_budget.empty() &&
+        !MemoryBudget::ParseSize(opts.memory_budget, opts.memory_limit))
+    {
+        fmt::print(std::cerr, "mrdle: Invalid memory budget: {}\n", opts.memory_budget);
+        return -1;
+    }
+
+    // Numeric options
+    uint64_t seed = 0;
+    if (!opts.seed.empty()) {
+        if (!ParseNumber(opts.seed, seed)) {
+            fmt::print(std::cerr, "mrdle: Invalid seed: {}\n", opts.seed);
+            return -1;
+        }
+        opts.seed_value = seed;
+    }
+    if (!opts.games.empty() && (!ParseNumber(opts.games, opts.game_count) || !opts.game_count)) {
+        fmt::print(std::cerr, "mrdle: Invalid game count: {}\n", opts.games);
+        return -1;
+    }
+    if (!opts.threads.empty() && (!ParseNumber(opts.threads, opts.thread_count) || !opts.thread_count)) {
+        fmt::print(std::cerr, "mrdle: Invalid thread count: {}\n", opts.threads);
+        return -1;
+    }
+    if (!opts.evaluations.empty() &&
+        (!ParseNumber(opts.evaluations, opts.evaluation_count) || !opts.evaluation_count))
+    {
+        fmt::print(std::cerr, "mrdle: Invalid evaluation count: {}\n", opts.evaluations);
+        return -1;
+    }
+
+    if (!opts.feedback.empty() && !ParseFeedback(opts.feedback, opts.feedback_model)) {
+        fmt::print(std::cerr, "mrdle: Unknown feedback: {}\n", opts.feedback);
+        return -1;
+    }
+
     // Convert any input words to lower case
     string_to_lower(opts.secret_word);
+    string_to_lower(opts.query);
     for (auto& h : opts.hint_vect)
         string_to_lower(h.first);
 
@@ -201,19 +375,82 @@ static int DisplayHelp(const ProgOpts& opts)
     fmt::print("\nActions:\n");
     fmt::print("  --play              Shall we play a game? (default action)\n");
     fmt::print("  --list              List words from word list (see --hint)\n");
+    fmt::print("  --suggest           Suggest the most informative guesses for the words that\n");
+    fmt::print("                      satisfy --hint and --query\n");
+    fmt::print("  --any-probe         Find the most informative guess for the same words if any\n");
+    fmt::print("                      letter string were allowed (uses --threads)\n");
+    fmt::print("  --find-traps        List families of words that differ in only one letter,\n");
+    fmt::print("                      with the fewest guesses that tell them apart\n");
+    fmt::print("  --union FILE        Combine the word list with the words in FILE; so do\n");
+    fmt::print("  --intersect FILE    --intersect (words in both) and --diff (words not in\n");
+    fmt::print("  --diff FILE         FILE). They apply in order and may repeat. Writes the\n");
+    fmt::print("                      result to --output FILE (default: standard output),\n");
+    fmt::print("                      as text or, with --binary, as sorted 64-bit keys\n");
+    fmt::print("  --tournament        Play solver strategies against the same secrets and\n");
+    fmt::print("                      compare them (see Tournament options)\n");
+    fmt::print("  --tune              Search the heuristic strategy's weights by simulated\n");
+    fmt::print("                      games (see Tournament options)\n");
+    fmt::print("  --batch             Read sets of hints from standard input, one set per line\n");
+    fmt::print("                      (WORD HINT [WORD HINT...]), and list the matching words\n");
+    fmt::print("                      for each, followed by an empty line. With --suggest,\n");
+    fmt::print("                      suggests guesses for each instead\n");
   //fmt::print("  --rules             Display game rules and exit\n");
   //fmt::print("  --player-stats      Display stats for the current user\n");
     fmt::print("\n");
     fmt::print("Game options:\n");
     fmt::print("  --secret-word WORD  Uses WORD as the secret word.\n");
+    fmt::print("  --seed N            Seed for random choices; the same seed picks the same\n");
+    fmt::print("                      secret words\n");
+    fmt::print("  --feedback RULE     Clue each guess gets, for the game, --hint and every\n");
+    fmt::print("                      solver: wordle (default; e.g., '!x~xx'), jotto (letters\n");
+    fmt::print("                      in common; e.g., '2') or greens (letters in the right\n");
+    fmt::print("                      spot; e.g., '1')\n");
     fmt::print("List words options:\n");
     fmt::print("  --hint WORD HINT    Implies --list. Filters listed words by excluding words\n");
     fmt::print("                      that do not satisfy the game hint. WORD is a word that\n");
     fmt::print("                      was played and HINT is the encoded results of that word\n");
     fmt::print("                      See Finding Solutions below.\n");
+    fmt::print("  --query QUERY       Implies --list. Filters listed words by a crossword-style\n");
+    fmt::print("                      query. See Queries below.\n");
+    fmt::print("  --xordle            There are two secrets that share no letters, and each\n");
+    fmt::print("                      HINT is the clue against both (a letter's best result\n");
+    fmt::print("                      against either). Lists, or with --suggest ranks guesses\n");
+    fmt::print("                      against, the pairs of words that fit (uses --threads)\n");
+    fmt::print("  --explain           After the list, show how many words each hint (and the\n");
+    fmt::print("                      query) rules out on its own and how many it was the\n");
+    fmt::print("                      first to rule out\n");
+    fmt::print("  --explain-words     Same, plus each word ruled out and the first hint that\n");
+    fmt::print("                      ruled it out\n");
+    fmt::print("  --letter-stats      Instead of the words, show how many have each letter,\n");
+    fmt::print("                      how often it appears and how often at each position.\n");
+    fmt::print("                      With --batch, a repeated set of hints is a lookup.\n");
+    fmt::print("  --json              Show --letter-stats as JSON\n");
+    fmt::print("  --timings           Report filter stage timings to stderr\n");
+    fmt::print("Tournament options:\n");
+    fmt::print("  --strategies LIST   Comma separated strategies to play (default: all):\n");
+    fmt::print("                      entropy, candidate-entropy, minimax, heuristic,\n");
+    fmt::print("                      frequency, random\n");
+    fmt::print("  --games N           Play N random secrets (see --seed) instead of every\n");
+    fmt::print("                      word in the word list\n");
+    fmt::print("  --threads N         Games to play at once (default: one per core)\n");
+    fmt::print("  --weights FILE      Weights for the heuristic strategy; --tune starts\n");
+    fmt::print("                      from them (if FILE exists) and writes the best to FILE\n");
+    fmt::print("  --evaluations N     Simulations --tune may run (default: 100)\n");
     fmt::print("Common options:\n");
     fmt::print("  --word-file FILE    Use words listed in FILE. Words can be of any length\n");
     fmt::print("                      but they must all be the same length.\n");
+    fmt::print("  --dict-image FILE   Share the loaded dictionary with other mrdle processes\n");
+    fmt::print("                      through FILE. The first process builds and publishes\n");
+    fmt::print("                      it; the rest map it read-only.\n");
+    fmt::print("  --cache-dir DIR     Keep data derived from the word list in DIR, keyed by\n");
+    fmt::print("                      the word list contents, so it's only built once\n");
+    fmt::print("  --watch             Reload the word list when the word file changes or on\n");
+    fmt::print("                      SIGHUP, without restarting\n");
+    fmt::print("  --memory-budget SIZE\n");
+    fmt::print("                      Limit memory used by indexes and caches to SIZE bytes\n");
+    fmt::print("                      (K, M and G suffixes allowed). Optional indexes are\n");
+    fmt::print("                      skipped and caches shrunk to fit.\n");
+    fmt::print("  --memory-report     Report what the memory budget kept and why to stderr\n");
     fmt::print("  --no-color          Do not use colored output\n");
     fmt::print("  --version           Display version information and exit\n");
     fmt::print("  --help              Display usage information and exit\n");
@@ -232,12 +469,26 @@ static int DisplayHelp(const ProgOpts& opts)
     fmt::print("        wrong spot (i.e., a yellow letter)\n");
     fmt::print("      - 'x' means that the character is not in the unmatched portion\n");
     fmt::print("         of the secret word (i.e., a gray letter)\n");
+    fmt::print("      - '?' means that the result isn't known; words that could have\n");
+    fmt::print("        given any result there match\n");
     fmt::print("\n");
     fmt::print("The more hints you provide on the command line, the more refined the output\n");
     fmt::print("will be:\n");
     fmt::print("$mrdle --hint arise 'x~x~~' --hint route '!x~x~' --hint rules '!~x~!'\n");
     fmt::print("rebus\n");
     fmt::print("\n");
+    fmt::print("Queries:\n");
+    fmt::print("A query is a list of terms separated by spaces or commas. A word is listed\n");
+    fmt::print("if it satisfies all of the terms.\n");
+    fmt::print("  a??le     Pattern; one character per letter, '?' or '.' is any letter\n");
+    fmt::print("  ab*       Word starts with \"ab\"\n");
+    fmt::print("  *er       Word ends with \"er\"\n");
+    fmt::print("  +rt       Word contains r and t\n");
+    fmt::print("  -e        Word does not contain e\n");
+    fmt::print("  :double   Word has a repeated letter\n");
+    fmt::print("  :single   Word has no repeated letters\n");
+    fmt::print("$mrdle --query '*er +t -e :single'\n");
+    fmt::print("\n");
 
     return 0;
 }
@@ -0,0 +1,176 @@
+/**
+ * @file    memory_budget.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements MemoryBudget; decides which caches and indexes get memory
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <fmt/format.h>
+#include <algorithm>
+#include <charconv>
+
+#include "memory_budget.h"
+
+/// Format a byte count for humans
+static std::string FormatBytes(size_t bytes)
+{
+    if (bytes == MemoryBudget::unlimited)
+        return "unlimited";
+
+    constexpr std::string_view units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    double v = static_cast<double>(bytes);
+    size_t u = 0;
+    while ((v >= 1024.0) && (u + 1 < std::size(units))) {
+        v /= 1024.0;
+        ++u;
+    }
+
+    return (0 == u) ? fmt::format("{} B", bytes) : fmt::format("{:.1f} {}", v, units[u]);
+}
+
+/// Ask for memory for a structure
+size_t MemoryBudget::Request(std::string_view name, size_t min_bytes, size_t max_bytes,
+    double value, bool required, ShrinkFn shrink)
+{
+    std::lock_guard lock(m_lock);
+
+    std::erase_if(m_items, [name](const Item& i) { return i.name == name; });
+
+    Item item{std::string(name), max_bytes, std::min(min_bytes, max_bytes), 0, value,
+        required, false, std::move(shrink), {}};
+
+    const size_t used = GetGrantedLocked();
+    size_t avail = (used < m_limit) ? m_limit - used : 0;
+
+    if (required) {
+        item.granted = max_bytes;
+        item.why = (max_bytes > avail) ? "required; over budget" : "required";
+    }
+    else {
+        // Less valuable caches may give memory back to a more valuable
+        // newcomer, least valuable first; but only if that's enough to
+        // make the newcomer useful.
+        if (avail < max_bytes) {
+            std::vector<Item*> donors;
+            size_t reclaimable = 0;
+            for (auto& i : m_items) {
+                if (i.shrink && (i.value < value) && (i.granted > i.min_bytes)) {
+                    donors.push_back(&i);
+                    reclaimable += i.granted - i.min_bytes;
+                }
+            }
+
+            if (avail + reclaimable >= item.min_bytes) {
+                std::sort(donors.begin(), donors.end(),
+                    [](const Item* a, const Item* b) { return a->value < b->value; });
+                for (auto* d : donors) {
+                    if (avail >= max_bytes)
+                        break;
+                    const size_t take = std::min(d->granted - d->min_bytes, max_bytes - avail);
+                    d->granted -= take;
+                    d->shrink(d->granted);
+                    d->why = fmt::format("shrunk for {}", item.name);
+                    avail += take;
+                }
+            }
+        }
+
+        const size_t grant = std::min(max_bytes, avail);
+        if ((grant < item.min_bytes) || ((0 == grant) && (max_bytes > 0)))
+            item.why = "dropped; over budget";
+        else {
+            item.granted = grant;
+            item.why = (grant == max_bytes) ? "kept" : "partial; over budget";
+        }
+    }
+
+    const size_t granted = item.granted;
+    m_items.push_back(std::move(item));
+    return granted;
+}
+
+/// Record memory that is shared with other processes
+void MemoryBudget::RecordShared(std::string_view name, size_t bytes)
+{
+    std::lock_guard lock(m_lock);
+
+    std::erase_if(m_items, [name](const Item& i) { return i.name == name; });
+    m_items.push_back(Item{std::string(name), bytes, bytes, 0, 0, true, true, nullptr,
+        "shared; mapped read-only"});
+}
+
+/// Forget a structure
+void MemoryBudget::Release(std::string_view name)
+{
+    std::lock_guard lock(m_lock);
+    std::erase_if(m_items, [name](const Item& i) { return i.name == name; });
+}
+
+/// Returns the total bytes granted
+size_t MemoryBudget::GetGranted() const
+{
+    std::lock_guard lock(m_lock);
+    return GetGrantedLocked();
+}
+
+size_t MemoryBudget::GetGrantedLocked() const
+{
+    size_t total = 0;
+    for (const auto& i : m_items)
+        total += i.granted;
+
+    return total;
+}
+
+/// Returns a table of what was kept, shrunk or dropped and why
+std::string MemoryBudget::GetReport() const
+{
+    std::lock_guard lock(m_lock);
+
+    std::string report = fmt::format("Memory budget: {}; granted {}\n",
+        FormatBytes(m_limit), FormatBytes(GetGrantedLocked()));
+    report += fmt::format("  {:<24} {:>11} {:>11} {:>8}  {}\n",
+        "structure", "wanted", "granted", "value/B", "decision");
+    for (const auto& i : m_items) {
+        const auto value = i.required ? std::string("-") : fmt::format("{:.2f}", i.value);
+        report += fmt::format("  {:<24} {:>11} {:>11} {:>8}  {}\n", i.name,
+            FormatBytes(i.wanted), FormatBytes(i.shared ? i.wanted : i.granted), value, i.why);
+    }
+
+    return report;
+}
+
+/// Parse a size such as 4096, 512K, 64M or 2G; returns false if invalid
+bool MemoryBudget::ParseSize(std::string_view text, size_t& bytes)
+{
+    uint64_t v = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), v);
+    if ((ec != std::errc()) || (end == text.data()))
+        return false;
+
+    std::string_view suffix(end, text.data() + text.size() - end);
+    if (suffix.ends_with("iB") || suffix.ends_with("ib"))
+        suffix.remove_suffix(2);
+    else if ((suffix.length() > 1) && ((suffix.back() == 'B') || (suffix.back() == 'b')))
+        suffix.remove_suffix(1);
+
+    int shift = 0;
+    if (suffix.length() > 1)
+        return false;
+    if (suffix.length() == 1) {
+        switch (suffix[0]) {
+        case 'k': case 'K': shift = 10; break;
+        case 'm': case 'M': shift = 20; break;
+        case 'g': case 'G': shift = 30; break;
+        case 't': case 'T': shift = 40; break;
+        case 'b': case 'B': shift = 0;  break;
+        default: return false;
+        }
+    }
+
+    if (v > (std::numeric_limits<uint64_t>::max() >> shift))
+        return false;
+    bytes = static_cast<size_t>(v << shift);
+    return true;
+}
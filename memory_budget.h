@@ -0,0 +1,98 @@
+/**
+ * @file    memory_budget.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares MemoryBudget; decides which caches and indexes get memory
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef memory_budget__header_included
+#define memory_budget__header_included
+
+#include <string_view>
+#include <functional>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <string>
+#include <mutex>
+
+/**
+ * @brief A process-wide memory budget for derived data
+ *
+ * Every index, table, and cache asks the budget for memory before it's
+ * built, stating how much it wants, how little it can live with, and how
+ * valuable each byte is (a relative figure; higher is more valuable).
+ * Required structures are always granted. Optional ones get what's left,
+ * and a valuable newcomer may shrink less valuable caches that can give
+ * memory back. Everything is recorded for the report.
+ */
+class MemoryBudget {
+public:
+
+    /// Shrinks a cache to the given number of bytes
+    using ShrinkFn = std::function<void(size_t bytes)>;
+
+    static constexpr size_t unlimited = std::numeric_limits<size_t>::max();
+
+    // -- Construction
+
+    explicit MemoryBudget(size_t limit = unlimited) noexcept : m_limit(limit) {}
+
+    // -- Methods
+
+    /**
+     * @brief Ask for memory for a structure
+     *
+     * @param name          Name of the structure; a new request under the
+     *  same name replaces the old one
+     * @param min_bytes     Least memory the structure is useful with
+     * @param max_bytes     Memory the structure would like
+     * @param value         Relative value of each byte
+     * @param required      Structure is built regardless of the budget
+     * @param shrink        If given, the structure can give memory back
+     *  later; it may then be shrunk down to min_bytes
+     *
+     * @return Returns the number of bytes granted; either 0 or a value in
+     *  [min_bytes, max_bytes]
+     */
+    size_t Request(std::string_view name, size_t min_bytes, size_t max_bytes,
+        double value, bool required = false, ShrinkFn shrink = nullptr);
+    /// Record memory that is shared with other processes
+    void RecordShared(std::string_view name, size_t bytes);
+    /// Forget a structure
+    void Release(std::string_view name);
+
+    /// Returns the budget
+    size_t GetLimit() const noexcept { return m_limit; }
+    /// Returns the total bytes granted
+    size_t GetGranted() const;
+
+    /// Returns a table of what was kept, shrunk or dropped and why
+    std::string GetReport() const;
+
+    /// Parse a size such as 4096, 512K, 64M or 2G; returns false if invalid
+    static bool ParseSize(std::string_view text, size_t& bytes);
+
+private:
+
+    struct Item {
+        std::string     name;
+        size_t          wanted{0};              ///< max_bytes of the request
+        size_t          min_bytes{0};           ///< min_bytes of the request
+        size_t          granted{0};             ///< Bytes currently granted
+        double          value{0};               ///< Value per byte
+        bool            required{false};
+        bool            shared{false};          ///< Mapped; not charged
+        ShrinkFn        shrink;
+        std::string     why;                    ///< Explanation for the report
+    };
+
+    size_t GetGrantedLocked() const;
+
+    mutable std::mutex  m_lock;
+    size_t              m_limit;
+    std::vector<Item>   m_items;                ///< In request order
+};
+
+#endif // ifndef memory_budget__header_included
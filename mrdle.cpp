@@ -12,27 +12,281 @@
 #include <stdexcept>
 #include <algorithm>
 #include <iostream>
+#include <filesystem>
 #include <fstream>
+#include <sstream>
+#include <csignal>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+#include <array>
+#include <bit>
+#include <random>
 #include <map>
 
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <poll.h>
+#endif
+
+#include "hint_constraints.h"
+#include "artifact_cache.h"
+#include "word_query.h"
+#include "tournament.h"
+#include "probe.h"
+#include "traps.h"
+#include "tuner.h"
 #include "mrdle.h"
 #include "util.h"
 
-mrdle::mrdle(const std::string_view word_file)
-    : m_prng_gen(std::random_device()())
+// Defined in word_list.cpp
+extern std::string_view default_words_blob;
+extern size_t           default_word_size;
+
+mrdle::mrdle(const std::string_view word_file, const std::string_view dict_image,
+    const std::string_view cache_dir, size_t memory_budget)
+    : m_word_file(word_file), m_dict_image(dict_image), m_budget(memory_budget),
+      m_seed((uint64_t(std::random_device()()) << 32) | std::random_device()()),
+      m_misc_stream(m_seed, misc_stream)
 {
-    if (word_file.empty())
-        InitWordListInternal();
+    if (!cache_dir.empty()) {
+        m_cache = std::make_unique<ArtifactCache>(cache_dir);
+        if (!m_cache->IsValid()) {
+            fmt::print(std::cerr, "mrdle: Can't use cache directory: {}\n", cache_dir);
+            m_cache.reset();
+        }
+    }
+
+    auto dict = LoadDictionary();
+    m_dict.store(dict ? std::move(dict) : std::make_shared<const Dictionary>());
+}
+
+mrdle::~mrdle()
+{
+    // Stop watching before anything the watcher uses goes away
+    if (m_watcher.joinable()) {
+        m_watcher.request_stop();
+        m_watcher.join();
+    }
+}
+
+/// Load the word list and build (or attach to) a dictionary for it
+std::shared_ptr<const Dictionary> mrdle::LoadDictionary(const Dictionary* base) const
+{
+    auto dict = std::make_shared<Dictionary>();
+    const auto stamp = GetWordListStamp(m_word_file);
+
+    // If another process already published this dictionary, share it.
+    // Whoever built it decided which indexes it has.
+    if (!m_dict_image.empty() && dict->Attach(m_dict_image, stamp)) {
+        m_budget.Release("positional index");
+        m_budget.Release("edit-distance index");
+        m_budget.RecordShared("dictionary", dict->GetImageBytes());
+        return dict;
+    }
+
+    word_list words;
+    Dictionary::Weights weights;
+    if (m_word_file.empty())
+        InitWordListInternal(words);
     else
-        InitWordListFile(word_file);
+        InitWordListFile(m_word_file, words, weights);
+    if (words.empty())
+        return nullptr;
+
+    const auto options = PlanDictionary(words.size(), words[0].length(), !weights.empty());
+
+    // The artifact cache files the image under the word list contents, so
+    // any run over the same words finds it already built.
+    if (m_cache) {
+        Dictionary::Sort(words, weights);
+        const auto hash = Dictionary::HashWords(words, weights);
+        std::string name = "dict";
+        if (!options.positional_index)
+            name += "-nopos";
+        if (!options.word_tree)
+            name += "-notree";
+        MappedFile mapping;
+        auto build = [&words, &weights, hash, &options, base](ImageWriter& out)
+            { Dictionary::Write(words, weights, hash, out, options, base); };
+        const bool found = m_cache->LookupOrBuild(name, Dictionary::image_version, hash,
+            build, mapping);
+        bool attached = found && dict->Attach(mapping, hash);
+
+        // A damaged entry would be found again by every run; replace it
+        if (found && !attached) {
+            mapping.Close();
+            attached = m_cache->Remove(name, Dictionary::image_version, hash) &&
+                m_cache->LookupOrBuild(name, Dictionary::image_version, hash, build, mapping) &&
+                dict->Attach(mapping, hash);
+        }
+
+        // Other processes may be sharing the published image rather than
+        // the cache; they check it against the word list stamp
+        if (attached) {
+            if (!m_dict_image.empty() && !dict->Publish(m_dict_image, stamp))
+                fmt::print(std::cerr, "mrdle: Failed to publish dictionary image: {}\n", m_dict_image);
+            return dict;
+        }
+    }
+
+    // Pack the words and build everything derived from them
+    dict->Build(std::move(words), std::move(weights), stamp, options, base);
+
+    // Publish it for other processes and then use the shared copy ourselves
+    if (!m_dict_image.empty()) {
+        if (!dict->Publish(m_dict_image))
+            fmt::print(std::cerr, "mrdle: Failed to publish dictionary image: {}\n", m_dict_image);
+        else
+            dict->Attach(m_dict_image, stamp);
+    }
+
+    return dict;
 }
 
-/// Initialize word list from a file
-void mrdle::InitWordListFile(std::string_view word_file)
+/// Ask the memory budget which optional dictionary indexes to build
+Dictionary::Options mrdle::PlanDictionary(size_t word_count, size_t word_size,
+    bool weighted) const
+{
+    // The words and their columns are the dictionary; the indexes only make
+    // things faster. The positional index speeds up every selective query,
+    // the edit distance index only the "did you mean" prompt.
+    const auto fp = Dictionary::GetFootprint(word_count, word_size, weighted);
+    m_budget.Request("dictionary", fp.base, fp.base, 0, true);
+
+    Dictionary::Options options;
+    options.positional_index = m_budget.Request("positional index",
+        fp.positional_index, fp.positional_index, 4.0) > 0;
+    options.word_tree = m_budget.Request("edit-distance index",
+        fp.word_tree, fp.word_tree, 2.0) > 0;
+
+    return options;
+}
+
+/// Rebuild the dictionary from its source and swap it in
+bool mrdle::Reload()
+{
+    // Readers holding the old snapshot keep using it; it goes away when
+    // the last of them lets go.
+    const auto t_start = std::chrono::steady_clock::now();
+    const auto old_dict = GetDictionary();
+    auto dict = LoadDictionary(old_dict.get());
+    if (!dict) {
+        fmt::print(std::cerr, "mrdle: Reload failed; keeping current word list\n");
+        return false;
+    }
+
+    m_dict.store(std::move(dict));
+
+    if (m_timings) {
+        const auto ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - t_start).count();
+        fmt::print(std::cerr, "Reloaded {} words in {:.1f} ms\n", GetWordListCount(), ms);
+    }
+    return true;
+}
+
+/// Set by SIGHUP to request a reload
+static std::atomic<bool> reload_requested{false};
+
+/// Reload the dictionary whenever the word file changes or on SIGHUP
+void mrdle::EnableAutoReload()
+{
+    if (m_watcher.joinable())
+        return;
+
+#if defined(SIGHUP)
+    std::signal(SIGHUP, [](int) { reload_requested = true; });
+#endif
+
+    m_watcher = std::jthread([this](std::stop_token stop) { WatchWordList(stop); });
+}
+
+/// Watcher thread body; see EnableAutoReload
+void mrdle::WatchWordList(std::stop_token stop)
 {
-    constexpr size_t alloc_chunk = 25;
+    // Wake at least this often to check for SIGHUP and for stop requests
+    constexpr int wake_ms = 500;
+    // Time a changed word file must stay unchanged before it's reloaded
+    constexpr int settle_ms = 100;
+
+#if defined(__linux__)
+    // Watch the directory rather than the file so that editors which
+    // replace the file by renaming over it are noticed too.
+    int fd = -1;
+    if (!m_word_file.empty()) {
+        fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        const auto dir = std::filesystem::absolute(m_word_file).parent_path();
+        if ((fd >= 0) && (::inotify_add_watch(fd, dir.c_str(),
+            IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0))
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+#endif
+
+    auto stamp = GetWordListStamp(m_word_file);
+    while (!stop.stop_requested()) {
+
+#if defined(__linux__)
+        if (fd >= 0) {
+            // Drain events; the stamp check below decides if it matters
+            pollfd pfd{fd, POLLIN, 0};
+            if (::poll(&pfd, 1, wake_ms) > 0) {
+                char buf[4096];
+                while (::read(fd, buf, sizeof(buf)) > 0);
+            }
+        }
+        else
+#endif
+            std::this_thread::sleep_for(std::chrono::milliseconds(wake_ms));
+
+        auto new_stamp = GetWordListStamp(m_word_file);
+        if (reload_requested.exchange(false) || (new_stamp != stamp)) {
+
+            // Let whoever is writing the file finish before reading it
+            for (auto prev = stamp; prev != new_stamp; ) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(settle_ms));
+                prev = std::exchange(new_stamp, GetWordListStamp(m_word_file));
+            }
+
+            stamp = new_stamp;
+            Reload();
+        }
+    }
+
+#if defined(__linux__)
+    if (fd >= 0)
+        ::close(fd);
+#endif
+}
+
+/// Returns a value that changes whenever the word list source changes
+uint64_t mrdle::GetWordListStamp(std::string_view word_file)
+{
+    // The internal list only changes with the program
+    if (word_file.empty())
+        return hash_fnv1a(default_words_blob);
+
+    // Identify a word file by its path, size, and modification time
+    std::error_code ec;
+    const std::filesystem::path path(word_file);
+    const auto size  = std::filesystem::file_size(path, ec);
+    const auto mtime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+
+    uint64_t stamp = hash_fnv1a(std::filesystem::absolute(path, ec).string());
+    stamp = hash_fnv1a(std::to_string(size), stamp);
+    return hash_fnv1a(std::to_string(mtime), stamp);
+}
 
-    m_words.clear();
+/// Initialize word list from a file
+void mrdle::InitWordListFile(std::string_view word_file, word_list& words,
+    Dictionary::Weights& weights)
+{
+    words.clear();
+    weights.clear();
 
     std::ifstream ifs{std::string(word_file)};
     if (!ifs.is_open()) {
@@ -40,24 +294,57 @@ void mrdle::InitWordListFile(std::string_view word_file)
         return;
     }
 
+    // A word set written by --binary
+    std::string magic(WordSet::binary_magic.size(), '\0');
+    if (ifs.read(magic.data(), magic.size()) && (magic == WordSet::binary_magic)) {
+        WordSet set;
+        if (!set.Read(std::string(word_file), 0))
+            return;
+        for (size_t i = 0; i < set.keys.size(); ++i) {
+            words.push_back(WordSet::GetWord(set.keys[i], set.word_size));
+            if (set.weighted)
+                weights.push_back(set.weights[i]);
+        }
+        return;
+    }
+    ifs.clear();
+    ifs.seekg(0);
+
     std::string word;
     size_t word_len = 0;
+    bool weighted = false;
 
     while(std::getline(ifs, word)) {
 
-        // Grow vector in spurts
-        if (m_words.size() == m_words.capacity())
-            m_words.reserve(m_words.capacity() + alloc_chunk);
-
         // Trim whitespace from the word
         string_trim(word);
 
+        // An optional second column is the word's frequency (or any other
+        // relative weight); words without one get a weight of 1
+        float weight = 1.0f;
+        const auto space = word.find_first_of(" \t");
+        if (space != std::string::npos) {
+            const std::string freq = word.substr(word.find_first_not_of(" \t", space));
+            char* end = nullptr;
+            const double v = std::strtod(freq.c_str(), &end);
+            if ((end != freq.c_str() + freq.length()) || !std::isfinite(v) || (v < 0)) {
+                fmt::print(std::cerr, "Invalid word file: Bad frequency: {}\n", word);
+                words.clear();
+                weights.clear();
+                return;
+            }
+            weight = static_cast<float>(v);
+            weighted = true;
+            word.resize(space);
+        }
+
         // All words must be the same length
         if (0 == word_len)
             word_len = word.length();
         if (word.length() != word_len) {
             fmt::print(std::cerr, "Invalid word file: Inconsistent word length: {}\n", word);
-            m_words.clear();
+            words.clear();
+            weights.clear();
             return;
         }
 
@@ -65,44 +352,76 @@ void mrdle::InitWordListFile(std::string_view word_file)
         string_to_lower(word);
 
         // Move into our vector
-        m_words.emplace_back(std::move(word));
+        words.emplace_back(std::move(word));
+        weights.push_back(weight);
     }
 
-    // Make sure list is sorted so we can quickly search
-    std::sort(m_words.begin(), m_words.end());
+    // A list without frequencies is unweighted
+    if (!weighted)
+        weights.clear();
 }
 
-// Defined in word_list.cpp
-extern std::string_view default_words_blob;
-extern size_t           default_word_size;
-
 /// Initialize word list from internal word list
-void mrdle::InitWordListInternal()
+void mrdle::InitWordListInternal(word_list& words)
 {
     // The default word blob is just a blob of words with all whitespace
     // removed. Since we know the word length, it's easy to pull them out
     // and put them into our vector.
     size_t word_count = default_words_blob.length() / default_word_size;
 
-    m_words.resize(word_count);
+    words.resize(word_count);
 
     size_t idx = 0;
     for (size_t i = 0; i<word_count; ++i, idx += default_word_size)
-        m_words[i].assign(default_words_blob.substr(idx, default_word_size));
+        words[i].assign(default_words_blob.substr(idx, default_word_size));
+}
+
+std::string mrdle::GetRandomWord() const
+{
+    return GetRandomWord(m_next_game++);
 }
 
-const std::string& mrdle::GetRandomWord() const
+/// Returns the random word for a game; depends only on the seed and game
+std::string mrdle::GetRandomWord(uint64_t game) const
 {
-    std::uniform_int_distribution<size_t> dist(0, m_words.size() - 1);
-    return m_words[dist(GetPrngGenerator())];
+    auto dict = GetDictionary();
+    auto stream = GetRandomStream(game);
+    return std::string(dict->GetWord(stream.Below(static_cast<uint32_t>(dict->GetWordCount()))));
 }
 
 /// Returns true if given word is in the word list
 bool mrdle::IsWordInList(const std::string& word) const
 {
-    // Our list is sorted; use a binary search to find it
-    auto it = std::lower_bound(m_words.begin(), m_words.end(), word);
-    return ((it != m_words.end()) && (0 == it->compare(word)));
+    auto dict = GetDictionary();
+    return dict->GetWords().Find(word) < dict->GetWordCount();
+}
+
+/// Returns the words in the word list closest to the given (non-)word
+std::vector<std::string> mrdle::GetSuggestions(std::string_view word,
+    size_t max_dist, size_t max_count) const
+{
+    auto dict = GetDictionary();
+    const auto& words = dict->GetWords();
+
+    auto matches = dict->GetWordTree().Find(words, word, max_dist, max_count);
+    if (!dict->GetWordTree().GetNodeCount()) {
+        // No index (memory budget); compare against every word instead
+        for (uint32_t w = 0; w < words.size(); ++w) {
+            const auto d = BkTree::Distance(words[w], word);
+            if (d <= max_dist)
+                matches.push_back(BkTree::Match{w, static_cast<uint32_t>(d)});
+        }
+        std::stable_sort(matches.begin(), matches.end(),
+            [](const auto& a, const auto& b) { return a.dist < b.dist; });
+        if (matches.size() > max_count)
+            matches.resize(max_count);
+    }
+
+    std::vector<std::string> suggestions;
+    for (const auto& m : matches)
+        suggestions.emplace_back(dict->GetWord(m.word));
+
+    return suggestions;
 }
 
 /**
@@ -122,7 +441,7 @@ bool mrdle::IsWordInList(const std::string& word) const
 bool mrdle::CheckWordGuess(const std::string& secret_word,
     const std::string& guess_word, std::string& result)
 {
-    if (!IsWordInList(guess_word))
+    if ((guess_word.length() != secret_word.length()) || !IsWordInList(guess_word))
         return false;
 
     result.resize(secret_word.length());
@@ -186,16 +505,29 @@ bool mrdle::TerminalPlay(std::string secret_word)
 
         // Check the guess against the word
         if (!CheckWordGuess(secret_word, guess, result)) {
-            fmt::print("Not a word\n");
+            auto suggestions = GetSuggestions(guess);
+            if (suggestions.empty())
+                fmt::print("Not a word\n");
+            else
+                fmt::print("Not a word; did you mean: {}?\n", fmt::join(suggestions, ", "));
             continue;
         }
 
-        // Update the character map
-        for (size_t i = 0; i<guess.length(); ++i)
-            char_map[guess[i]] = result[i];
+        if (std::holds_alternative<WordleFeedback>(m_feedback)) {
+            // Update the character map
+            for (size_t i = 0; i<guess.length(); ++i)
+                char_map[guess[i]] = result[i];
 
-        // Display the guess results
-        DisplayGuessResult(guess, result, char_map);
+            // Display the guess results
+            DisplayGuessResult(guess, result, char_map);
+        }
+        else {
+            // Other feedback models give one clue for the whole guess
+            const std::string clue = std::visit([&](auto model) {
+                return model.FormatClue(model.Compute(secret_word, guess), guess.length());
+            }, m_feedback);
+            fmt::print("{}  {}\n", guess, clue);
+        }
 
         // Are we done?
         if (guess.compare(secret_word) == 0) {
@@ -301,9 +633,7 @@ std::string_view mrdle::GetWinExclamatory(int guess_count) const
 /// Returns the string to use when player loses
 std::string_view mrdle::GetLoseInsult() const
 {
-    std::uniform_int_distribution dist(0, 25);
-
-    switch (dist(GetPrngGenerator())) {
+    switch (m_misc_stream.Below(26)) {
     case 0:  return "Wow, that was embarrassing.";
     case 1:  return "At least your head can serve as a hat rack.";
     case 2:  return "Were you dropped on your head as a child?";
@@ -315,67 +645,960 @@ std::string_view mrdle::GetLoseInsult() const
     }
 }
 
-/// List words with optional hints to filter output
-int mrdle::ListWords(const HintVect& hints)
+/// List words with optional hints and query to filter output
+int mrdle::ListWords(const HintVect& hints, std::string_view query)
 {
-    // Validate hints
+    // Everything below works on one snapshot, even if a reload happens
+    auto dict = GetDictionary();
+    if (m_letter_stats != LetterStatsMode::None)
+        return ShowLetterStats(dict, hints, query);
+    if (m_explain != Explain::None)
+        return ExplainWords(*dict, hints, query);
 
-    // Generare a string containing all valid result codes
-    std::string res_chars;
-    res_chars.append(1, res_matched);
-    res_chars.append(1, res_missing);
-    res_chars.append(1, res_mislaid);
+    std::vector<uint8_t> keep;
+    if (!FilterWords(*dict, hints, query, keep))
+        return 1;
 
-    for (auto&& [word,result] : hints) {
-        bool valid = true;      // Optimism
+    // For all words in our word list...
+    bool words_displayed = false;
+    for (size_t w = 0; w < dict->GetWordCount(); ++w) {
+        if (keep[w]) {
+            fmt::print("{}\n", dict->GetWord(w));
+            words_displayed = true;
+        }
+    }
 
-        // word and result length must match the game word size
-        if ((word.length() != GetWordSize()) || (result.length() != GetWordSize()))
-            valid = false;
-        // result string must be comprised of res_* chars
-        if (result.find_first_not_of(res_chars) != std::string::npos)
-            valid = false;
+    if (!words_displayed)
+        fmt::print("<No words matched>\n");
 
-        if (!valid) {
-            fmt::print(std::cerr, "Invalid hint: {} {}\n", word, result);
+    return 0;
+}
+
+/// Returns hints and a query in canonical form; requests that differ only in
+/// the order of their hints or query terms get the same key
+static std::string GetRequestKey(const mrdle::HintVect& hints, std::string_view query)
+{
+    std::vector<std::string> parts;
+    for (const auto& [hword, hres] : hints) {
+        std::string word = hword;
+        parts.push_back(string_to_lower(word) + ' ' + hres);
+    }
+    std::sort(parts.begin(), parts.end());
+    parts.erase(std::unique(parts.begin(), parts.end()), parts.end());
+
+    std::vector<std::string> terms;
+    for (size_t i = 0; i < query.length(); ) {
+        const size_t end = std::min(query.find_first_of(" ,", i), query.length());
+        if (end > i)
+            terms.emplace_back(query.substr(i, end - i));
+        i = end + 1;
+    }
+    std::sort(terms.begin(), terms.end());
+
+    return fmt::format("{}|{}", fmt::join(parts, ","), fmt::join(terms, " "));
+}
+
+/// Show letter stats for the words that satisfy the hints and query
+int mrdle::ShowLetterStats(const std::shared_ptr<const Dictionary>& dict, const HintVect& hints,
+    std::string_view query)
+{
+    const auto t_start = std::chrono::steady_clock::now();
+
+    // The cache holds counts over this word list, so it starts over with
+    // each dictionary. It's cheaper to rebuild than anything else, so it
+    // gives way first.
+    std::shared_ptr<LetterStatsCache> cache;
+    {
+        std::lock_guard lock(m_letter_stats_lock);
+        if (!m_letter_stats_cache) {
+            m_letter_stats_cache = std::make_shared<LetterStatsCache>(0);
+            std::weak_ptr<LetterStatsCache> weak = m_letter_stats_cache;
+            m_letter_stats_cache->SetLimit(m_budget.Request("letter stats", 0,
+                letter_stats_cache_bytes, 0.25, false,
+                [weak](size_t bytes) { if (auto c = weak.lock()) c->SetLimit(bytes); }));
+        }
+        if (m_letter_stats_dict.lock() != dict) {
+            m_letter_stats_cache->Clear();
+            m_letter_stats_dict = dict;
+        }
+        cache = m_letter_stats_cache;
+    }
+
+    // A request seen before is answered without filtering or counting
+    const std::string key = GetRequestKey(hints, query);
+    const uint64_t hash = hash_fnv1a(key);
+    auto stats = cache->Find(key, hash);
+    const bool hit = (stats != nullptr);
+    if (!hit) {
+        std::vector<uint8_t> keep;
+        if (!FilterWords(*dict, hints, query, keep))
             return 1;
+        std::vector<uint32_t> candidates;
+        for (uint32_t w = 0; w < keep.size(); ++w) {
+            if (keep[w])
+                candidates.push_back(w);
+        }
+
+        // Every word is counted from the dictionary's own totals, which
+        // costs next to nothing, so there's no point keeping it
+        stats = std::make_shared<const LetterStats>(LetterStats::Compute(dict->GetColumns(), candidates));
+        if (candidates.size() < dict->GetWordCount()) {
+            stats = cache->Insert(key, hash, stats,
+                sizeof(LetterStats) + stats->at.size() * sizeof(uint32_t));
         }
     }
+    const std::chrono::duration<double, std::micro> us = std::chrono::steady_clock::now() - t_start;
 
-    // For all words in our word list...
-    bool words_displayed = false;
-    for (const auto& w : m_words) {
-
-        // For each hint...
-        bool drop = false;
-        for (const auto& h : hints) {
-            if (!CheckWordAgainstHint(w, h)) {
-                // Current word is not a possible solution given this hint
-                drop = true;
-                break;
+    fmt::print("{}", (m_letter_stats == LetterStatsMode::Json) ?
+        stats->FormatJson() : stats->FormatTable());
+
+    if (m_timings) {
+        const auto st = cache->GetStats();
+        fmt::print(std::cerr, "Letter stats: {:.1f} us ({}); {} cached ({} bytes)\n",
+            us.count(), hit ? "cached" : "counted", st.entries, st.bytes);
+    }
+
+    return 0;
+}
+
+/// Explain which hints ruled out which words
+int mrdle::ExplainWords(const Dictionary& dict, const HintVect& hints, std::string_view query)
+{
+    constexpr size_t max_explained_hints = 64;      // Bits in a failure mask
+    if (hints.size() > max_explained_hints) {
+        fmt::print(std::cerr, "mrdle: --explain handles at most {} hints\n", max_explained_hints);
+        return 1;
+    }
+    if (!ValidateHints(hints, dict.GetWordSize(), m_feedback))
+        return 1;
+
+    // Hints that each leave words may still leave none together; say so,
+    // as FilterWords does, before the table shows what each one rules out
+    std::string error;
+    std::visit([&]<FeedbackModel F>(F) {
+        typename F::Prefilter pre;
+        if (!pre.Compile(hints, dict.GetWordSize(), error))
+            fmt::print(std::cerr, "Contradictory hints: {}\n", error);
+    }, m_feedback);
+
+    WordQuery wq;
+    if (!wq.Compile(query, dict.GetColumns(), error)) {
+        fmt::print(std::cerr, "Invalid query: {}\n", error);
+        return 1;
+    }
+    std::vector<uint8_t> in_query(dict.GetWordCount(), 1);
+    wq.Apply(dict.GetColumns(), in_query);
+
+    std::vector<uint64_t> fails;
+    FindHintFailures(dict, hints, fails);
+
+    // What each hint rules out on its own, and what it's the first to rule
+    // out (the query goes before every hint)
+    std::vector<size_t> alone(hints.size(), 0), first(hints.size(), 0);
+    size_t query_removed = 0, left = 0;
+    for (size_t w = 0; w < dict.GetWordCount(); ++w) {
+        for (uint64_t f = fails[w]; f; f &= f - 1)
+            ++alone[std::countr_zero(f)];
+        if (!in_query[w])
+            ++query_removed;
+        else if (fails[w])
+            ++first[std::countr_zero(fails[w])];
+        else {
+            fmt::print("{}\n", dict.GetWord(w));
+            ++left;
+        }
+    }
+    if (!left)
+        fmt::print("<No words matched>\n");
+
+    std::vector<std::string> labels;
+    size_t width = 12;
+    for (const auto& [hword, hres] : hints) {
+        labels.push_back(fmt::format("{} {}", hword, hres));
+        width = std::max(width, labels.back().length());
+    }
+
+    fmt::print("\n{:<{}}  {:>7}  {:>7}\n", "Ruled out by", width, "alone", "first");
+    if (!wq.IsEmpty())
+        fmt::print("{:<{}}  {:>7}  {:>7}\n", "query", width, query_removed, query_removed);
+    for (size_t h = 0; h < hints.size(); ++h)
+        fmt::print("{:<{}}  {:>7}  {:>7}\n", labels[h], width, alone[h], first[h]);
+    fmt::print("{:<{}}  {:>7}\n", "left", width, left);
+
+    if (m_explain == Explain::Words) {
+        fmt::print("\n");
+        for (size_t w = 0; w < dict.GetWordCount(); ++w) {
+            if (!in_query[w])
+                fmt::print("{}  query\n", dict.GetWord(w));
+            else if (fails[w]) {
+                const auto more = std::popcount(fails[w]) - 1;
+                fmt::print("{}  {}{}\n", dict.GetWord(w), labels[std::countr_zero(fails[w])],
+                    more ? fmt::format(" (and {} more)", more) : "");
             }
         }
-        if (drop)
-            continue;
+    }
 
-        fmt::print("{}\n", w);
-        words_displayed = true;
+    return 0;
+}
+
+/// Suggest the most informative guesses given optional hints and query
+int mrdle::SuggestWords(const HintVect& hints, std::string_view query, size_t count)
+{
+    auto dict = GetDictionary();
+    const size_t word_size = dict->GetWordSize();
+    if (word_size > max_pattern_word_size) {
+        fmt::print(std::cerr, "mrdle: Suggestions need words of at most {} letters\n",
+            max_pattern_word_size);
+        return 1;
     }
 
-    if (!words_displayed)
+    // Candidate secrets are the words that satisfy the hints
+    std::vector<uint8_t> keep;
+    if (!FilterWords(*dict, hints, query, keep))
+        return 1;
+    std::vector<uint32_t> candidates;
+    for (uint32_t w = 0; w < keep.size(); ++w) {
+        if (keep[w])
+            candidates.push_back(w);
+    }
+    if (candidates.empty()) {
         fmt::print("<No words matched>\n");
+        return 0;
+    }
+
+    const auto t_start = std::chrono::steady_clock::now();
+
+    // Score every word as a guess by the entropy of the partition that its
+    // patterns split the candidates into; more bits means more information.
+    // With word priors, each group is as likely as the total prior weight
+    // of its candidates rather than their count.
+    struct Score {
+        uint32_t    word;
+        double      bits;
+        size_t      groups;
+        bool        candidate;
+        double      win{0};         ///< Chance the guess is the answer
+        double      left{0};        ///< Expected candidates left after it
+    };
+    std::vector<Score> scores;
+    scores.reserve(dict->GetWordCount());
+
+    // Candidate priors, normalized, in candidate order so that the inner
+    // loop reads them contiguously
+    const auto weights = dict->GetWeights();
+    const bool weighted = !weights.empty();
+    std::vector<double> cand_weight;
+    std::vector<double> prior;
+    if (weighted) {
+        double sum = 0;
+        for (auto c : candidates)
+            sum += weights[c];
+        prior.assign(dict->GetWordCount(), 0.0);
+        cand_weight.reserve(candidates.size());
+        for (auto c : candidates) {
+            // All zero weights means no preference at all
+            const double w = (sum > 0) ? weights[c] / sum : 1.0 / candidates.size();
+            cand_weight.push_back(w);
+            prior[c] = w;
+        }
+    }
+
+    auto store = GetPatternStore(dict);
+    std::vector<uint32_t> hist(store->GetPatternCount(), 0);
+    std::vector<double> whist(weighted ? hist.size() : 0, 0.0);
+    std::vector<Pattern> pats(candidates.size());
+    std::vector<Pattern> touched;
+    const double total = static_cast<double>(candidates.size());
+
+    for (uint32_t g = 0; g < dict->GetWordCount(); ++g) {
+        const auto row = store->GetRow(g);
+        for (size_t i = 0; i < candidates.size(); ++i)
+            pats[i] = (*row)[candidates[i]];
+        for (auto p : pats) {
+            if (0 == hist[p]++)
+                touched.push_back(p);
+        }
+
+        Score sc{g, 0, touched.size(), bool(keep[g])};
+        if (weighted) {
+            for (size_t i = 0; i < pats.size(); ++i)
+                whist[pats[i]] += cand_weight[i];
+            for (auto p : touched) {
+                const double f = whist[p];
+                if (f > 0)
+                    sc.bits -= f * std::log2(f);
+                sc.left += f * hist[p];
+                hist[p] = 0;
+                whist[p] = 0;
+            }
+            sc.win = prior[g];
+        }
+        else {
+            for (auto p : touched) {
+                const double f = hist[p] / total;
+                sc.bits -= f * std::log2(f);
+                hist[p] = 0;
+            }
+        }
+        scores.push_back(sc);
+        touched.clear();
+    }
+
+    // Best first; prefer a guess that might be the answer, and the more
+    // likely answer at that
+    count = std::min(count, scores.size());
+    std::partial_sort(scores.begin(), scores.begin() + count, scores.end(),
+        [](const Score& a, const Score& b) {
+            if (a.bits != b.bits)
+                return a.bits > b.bits;
+            if (a.candidate != b.candidate)
+                return a.candidate > b.candidate;
+            return a.win > b.win;
+        });
+
+    fmt::print("{} candidate{}\n", candidates.size(), (candidates.size() == 1) ? "" : "s");
+    for (size_t i = 0; i < count; ++i) {
+        const auto& sc = scores[i];
+        if (weighted) {
+            fmt::print("{}  {:6.3f} bits  {:5} groups  {:6.2f}% win  {:8.1f} left{}\n",
+                dict->GetWord(sc.word), sc.bits, sc.groups, sc.win * 100, sc.left,
+                sc.candidate ? "  (candidate)" : "");
+        }
+        else {
+            fmt::print("{}  {:6.3f} bits  {:5} groups{}\n", dict->GetWord(sc.word), sc.bits,
+                sc.groups, sc.candidate ? "  (candidate)" : "");
+        }
+    }
+
+    if (m_timings) {
+        const auto us = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - t_start).count();
+        const auto st = store->GetStats();
+        fmt::print(std::cerr, "Ranking: {:.1f} us for {} guesses\n", us, scores.size());
+        fmt::print(std::cerr, "Pattern rows: {} hits, {} decoded, {} computed, {} loaded, {} inherited\n",
+            st.hits, st.decodes, st.computes, st.loads, st.inherited);
+        fmt::print(std::cerr, "  hot:  {} rows, {} bytes\n", st.hot_rows, st.hot_bytes);
+        fmt::print(std::cerr, "  cold: {} rows, {} bytes\n", st.cold_rows, st.cold_bytes);
+    }
+
+    return 0;
+}
+
+/// List the pairs of words that share no letters and satisfy the hints and query
+int mrdle::ListPairs(const HintVect& hints, std::string_view query)
+{
+    auto dict = GetDictionary();
+
+    std::vector<WordPair> pairs;
+    if (!FilterPairs(*dict, hints, query, pairs))
+        return 1;
+
+    for (const auto& p : pairs)
+        fmt::print("{} {}\n", dict->GetWord(p.first), dict->GetWord(p.second));
+    if (pairs.empty())
+        fmt::print("<No words matched>\n");
+
+    return 0;
+}
+
+/// Suggest the most informative guesses against the Xordle pairs
+int mrdle::SuggestPairs(const HintVect& hints, std::string_view query, size_t count,
+    size_t threads)
+{
+    auto dict = GetDictionary();
+
+    std::vector<WordPair> pairs;
+    if (!FilterPairs(*dict, hints, query, pairs))
+        return 1;
+    if (pairs.empty()) {
+        fmt::print("<No words matched>\n");
+        return 0;
+    }
+
+    const auto t_start = std::chrono::steady_clock::now();
+    auto store = GetPatternStore(dict);
+    auto scores = ScorePairGuesses(*store, pairs, threads);
+
+    // Best first; prefer a guess that might be one of the secrets
+    count = std::min(count, scores.size());
+    std::partial_sort(scores.begin(), scores.begin() + count, scores.end(),
+        [](const PairScore& a, const PairScore& b) {
+            if (a.bits != b.bits)
+                return a.bits > b.bits;
+            return a.candidate > b.candidate;
+        });
+
+    fmt::print("{} candidate pair{}\n", pairs.size(), (pairs.size() == 1) ? "" : "s");
+    for (size_t i = 0; i < count; ++i) {
+        const auto& sc = scores[i];
+        fmt::print("{}  {:6.3f} bits  {:5} groups{}\n", dict->GetWord(sc.guess), sc.bits,
+            sc.groups, sc.candidate ? "  (candidate)" : "");
+    }
+
+    if (m_timings) {
+        const auto us = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - t_start).count();
+        fmt::print(std::cerr, "Ranking: {:.1f} us for {} guesses against {} pairs\n",
+            us, scores.size(), pairs.size());
+    }
+
+    return 0;
+}
+
+/// Find the Xordle pairs for hints and query
+bool mrdle::FilterPairs(const Dictionary& dict, const HintVect& hints,
+    std::string_view query, std::vector<WordPair>& pairs) const
+{
+    // A clue against two secrets is Wordle's clue against each, combined
+    if (!std::holds_alternative<WordleFeedback>(m_feedback)) {
+        fmt::print(std::cerr, "mrdle: Xordle needs {} feedback\n", WordleFeedback::name);
+        return false;
+    }
+    const size_t word_size = dict.GetWordSize();
+    if (word_size > max_xordle_word_size) {
+        fmt::print(std::cerr, "mrdle: Xordle needs words of at most {} letters\n",
+            max_xordle_word_size);
+        return false;
+    }
+    if (!ValidateHints(hints, word_size, m_feedback))
+        return false;
+    for (const auto& [hword, hres] : hints) {
+        if (hres.find(res_any) != std::string::npos) {
+            fmt::print(std::cerr, "mrdle: Xordle hints can't have unknown results: {} {}\n",
+                hword, hres);
+            return false;
+        }
+    }
+
+    // Each secret must satisfy the query
+    std::vector<uint8_t> keep;
+    if (!FilterWords(dict, {}, query, keep))
+        return false;
+    std::vector<uint32_t> words;
+    for (uint32_t w = 0; w < keep.size(); ++w) {
+        if (keep[w])
+            words.push_back(w);
+    }
+
+    std::vector<PairClue> clues;
+    for (const auto& [hword, hres] : hints) {
+        PairClue& clue = clues.emplace_back(PairClue{hword});
+        WordleFeedback::ParseClue(hres, word_size, clue.clue);
+    }
+
+    const auto t_start = std::chrono::steady_clock::now();
+    pairs = FindPairs(dict, words, clues);
+
+    if (m_timings) {
+        const auto us = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - t_start).count();
+        fmt::print(std::cerr, "Pair search: {:.1f} us; {} words, {} pairs\n",
+            us, words.size(), pairs.size());
+    }
+
+    return true;
+}
+
+/// Find the most informative guess if any letter string were allowed
+int mrdle::FindAnyProbe(const HintVect& hints, std::string_view query, size_t threads)
+{
+    // Every string is 26^N of them; past 7 letters that's too many to search
+    constexpr size_t max_probe_word_size = 7;
+
+    // The bound on what a string can say is worked out from Wordle's rule
+    if (!std::holds_alternative<WordleFeedback>(m_feedback)) {
+        fmt::print(std::cerr, "mrdle: Probe search needs {} feedback\n", WordleFeedback::name);
+        return 1;
+    }
+
+    auto dict = GetDictionary();
+    if (dict->GetWordSize() > max_probe_word_size) {
+        fmt::print(std::cerr, "mrdle: Probe search needs words of at most {} letters\n",
+            max_probe_word_size);
+        return 1;
+    }
+
+    std::vector<uint8_t> keep;
+    if (!FilterWords(*dict, hints, query, keep))
+        return 1;
+    std::vector<uint32_t> candidates;
+    for (uint32_t w = 0; w < keep.size(); ++w) {
+        if (keep[w])
+            candidates.push_back(w);
+    }
+    if (candidates.empty()) {
+        fmt::print("<No words matched>\n");
+        return 0;
+    }
+
+    const auto t_start = std::chrono::steady_clock::now();
+    ProbeSearch search(*dict, candidates);
+    const auto r = search.Run(threads);
+
+    const bool is_word = IsWordInList(r.probe);
+    fmt::print("Candidates: {}\n", candidates.size());
+    fmt::print("Best probe: {}  {:6.3f} bits  {:5} groups{}\n", r.probe, r.bits, r.groups,
+        is_word ? "" : "  (not a word)");
+    fmt::print("Best word:  {}  {:6.3f} bits  {:5} groups\n", r.word, r.word_bits, r.word_groups);
+
+    if (m_timings) {
+        const std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - t_start;
+        fmt::print(std::cerr, "Searched {} strings in {:.1f} ms: {} prefixes visited, {} strings scored\n",
+            search.GetStringCount(), ms.count(), r.visited, r.scored);
+    }
+
+    return 0;
+}
+
+/// Combine a word list with other word files and write the result
+int mrdle::CombineWordLists(std::string_view word_file, const SetOpVect& ops,
+    const std::string& output_file, bool binary, bool timings)
+{
+    // The word list is the first operand
+    const auto t_start = std::chrono::steady_clock::now();
+    WordSet result;
+    if (!word_file.empty()) {
+        if (!result.Read(std::string(word_file), 0))
+            return 1;
+    }
+    else {
+        word_list words;
+        InitWordListInternal(words);
+        result.word_size = default_word_size;
+        for (const auto& w : words)
+            result.Add(WordSet::MakeKey(w));
+        result.Normalize();
+    }
+    const size_t word_size = result.word_size;
+
+    std::chrono::duration<double, std::milli> read_ms{0}, merge_ms{0};
+    for (const auto& [op, file] : ops) {
+        const auto t_read = std::chrono::steady_clock::now();
+        WordSet other;
+        if (!other.Read(file, word_size))
+            return 1;
+        const auto t_merge = std::chrono::steady_clock::now();
+        result = Combine(op, result, other);
+        read_ms += t_merge - t_read;
+        merge_ms += std::chrono::steady_clock::now() - t_merge;
+    }
+
+    const auto t_write = std::chrono::steady_clock::now();
+    if (!result.Write(output_file, binary)) {
+        fmt::print(std::cerr, "mrdle: Failed to write word file: {}\n", output_file);
+        return 1;
+    }
+
+    if (timings) {
+        const std::chrono::duration<double, std::milli> write_ms = std::chrono::steady_clock::now() - t_write;
+        const std::chrono::duration<double, std::milli> total_ms = std::chrono::steady_clock::now() - t_start;
+        fmt::print(std::cerr, "{} words; read {:.1f} ms, merged {:.1f} ms, wrote {:.1f} ms, total {:.1f} ms\n",
+            result.keys.size(), read_ms.count(), merge_ms.count(), write_ms.count(), total_ms.count());
+    }
+
+    return 0;
+}
+
+/// List families of words that differ in exactly one position
+int mrdle::FindTraps()
+{
+    auto dict = GetDictionary();
+    const auto& words = dict->GetWords();
+    if (dict->GetWordSize() > max_trap_word_size) {
+        fmt::print(std::cerr, "mrdle: Trap search needs words of at most {} letters\n",
+            max_trap_word_size);
+        return 1;
+    }
+
+    const auto t_start = std::chrono::steady_clock::now();
+    const auto clusters = FindTrapClusters(words);
+    const std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - t_start;
+
+    std::vector<uint8_t> trapped(words.size(), 0);
+    for (const auto& c : clusters) {
+        for (auto w : c.words)
+            trapped[w] = 1;
+    }
+    const size_t trapped_count = std::count(trapped.begin(), trapped.end(), 1);
+
+    fmt::print("{} trap clusters; {} of {} words are in at least one\n", clusters.size(),
+        trapped_count, words.size());
+    if (!clusters.empty()) {
+        // Probes: fewest extra guesses that tell the words apart
+        fmt::print("  {:<{}}  {:>5}  {:>6}  {}\n", "cluster", std::max<size_t>(7, words.GetWordSize()),
+            "words", "probes", "letters");
+        for (const auto& c : clusters) {
+            fmt::print("  {:<{}}  {:>5}  {:>6}  {}\n", c.GetPattern(words),
+                std::max<size_t>(7, words.GetWordSize()), c.words.size(),
+                c.GetSeparatingGuesses(words.GetWordSize()), c.GetLetters(words));
+        }
+    }
+
+    if (m_timings)
+        fmt::print(std::cerr, "Found {} clusters in {:.1f} ms\n", clusters.size(), ms.count());
+
+    return 0;
+}
+
+/// Play strategies against the same secrets and report how they compare
+int mrdle::RunTournament(std::string_view strategies, size_t games, size_t threads)
+{
+    auto dict = GetDictionary();
+    if (dict->GetWordSize() > max_pattern_word_size) {
+        fmt::print(std::cerr, "mrdle: Tournaments need words of at most {} letters\n",
+            max_pattern_word_size);
+        return 1;
+    }
+
+    Tournament::Options options;
+    options.games     = games;
+    options.threads   = threads;
+    options.seed      = m_seed;
+    options.artifacts = m_cache.get();
+    if (strategies.empty() || (strategies == "all")) {
+        options.strategies = GetAllStrategies();
+        for (auto& s : options.strategies) {
+            if (auto* h = std::get_if<HeuristicStrategy>(&s))
+                h->SetWeights(m_heuristic_weights);
+        }
+    }
+    else {
+        while (!strategies.empty()) {
+            const auto comma = strategies.find(',');
+            const auto name = strategies.substr(0, comma);
+            AnyStrategy s;
+            if (!ParseStrategy(name, s)) {
+                fmt::print(std::cerr, "mrdle: Unknown strategy: {}\n", name);
+                return 1;
+            }
+            if (auto* h = std::get_if<HeuristicStrategy>(&s))
+                h->SetWeights(m_heuristic_weights);
+            options.strategies.push_back(s);
+            strategies.remove_prefix((comma == std::string_view::npos) ? strategies.length() : comma + 1);
+        }
+    }
+
+    Tournament tournament(GetPatternStore(dict), std::move(options));
+    tournament.Run();
+    fmt::print("{}", tournament.GetReport());
+
+    if (m_timings) {
+        const auto st = GetPatternStore(dict)->GetStats();
+        fmt::print(std::cerr, "Pattern rows: {} hits, {} decoded, {} computed, {} loaded, {} inherited\n",
+            st.hits, st.decodes, st.computes, st.loads, st.inherited);
+    }
+
+    return 0;
+}
+
+/// Search the heuristic strategy's weights by simulated games
+int mrdle::TuneWeights(size_t games, size_t threads, size_t evaluations,
+    const std::string& weights_file)
+{
+    auto dict = GetDictionary();
+    if (dict->GetWordSize() > max_pattern_word_size) {
+        fmt::print(std::cerr, "mrdle: Tuning needs words of at most {} letters\n",
+            max_pattern_word_size);
+        return 1;
+    }
+    if (!weights_file.empty() && std::filesystem::exists(weights_file) &&
+        !LoadHeuristicWeights(weights_file))
+    {
+        return 1;
+    }
+
+    // Features are worth keeping across simulations but are cheaper to
+    // recompute than pattern rows, so they give way to rows first
+    auto cache = std::make_shared<FeatureCache>(0);
+    std::weak_ptr<FeatureCache> weak = cache;
+    cache->SetLimit(m_budget.Request("heuristic features", 0, FeatureCache::default_bytes, 0.5, false,
+        [weak](size_t bytes) { if (auto c = weak.lock()) c->SetLimit(bytes); }));
+
+    WeightTuner::Options options;
+    options.games           = games;
+    options.threads         = threads;
+    options.seed            = m_seed;
+    options.max_evaluations = evaluations;
+    options.artifacts       = m_cache.get();
+
+    const auto t_start = std::chrono::steady_clock::now();
+    fmt::print("{:>4}  {:<6}  {}\n", "sims", "score", fmt::join(heuristic_feature_names, " "));
+    WeightTuner tuner(GetPatternStore(dict), cache, options);
+    m_heuristic_weights = tuner.Run(m_heuristic_weights);
+
+    fmt::print("\nBest of {} simulations: {:.4f} guesses per game (a loss counts as {})\n",
+        tuner.GetEvaluationCount(), tuner.GetBestScore(), game_max_guesses + 1);
+    for (size_t i = 0; i < heuristic_feature_count; ++i)
+        fmt::print("  {:<10} {:.6g}\n", heuristic_feature_names[i], m_heuristic_weights[i]);
+
+    if (m_timings) {
+        const auto st = cache->GetStats();
+        const std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - t_start;
+        fmt::print(std::cerr, "Tuned in {:.0f} ms; states: {} hits, {} computed, {} cached ({} bytes)\n",
+            ms.count(), st.hits, st.computes, st.entries, st.bytes);
+    }
+
+    m_budget.Release("heuristic features");
+    if (!weights_file.empty() &&
+        !WriteHeuristicWeights(weights_file, m_heuristic_weights, tuner.GetBestScore()))
+    {
+        fmt::print(std::cerr, "mrdle: Failed to write weights file: {}\n", weights_file);
+        return 1;
+    }
+
+    return 0;
+}
+
+/// Read the heuristic strategy's weights; prints a message on failure
+bool mrdle::LoadHeuristicWeights(const std::string& path)
+{
+    if (!ReadHeuristicWeights(path, m_heuristic_weights)) {
+        fmt::print(std::cerr, "mrdle: Invalid weights file: {}\n", path);
+        return false;
+    }
+    return true;
+}
+
+/// Returns the pattern store for a dictionary snapshot
+std::shared_ptr<PatternStore> mrdle::GetPatternStore(const std::shared_ptr<const Dictionary>& dict)
+{
+    // Rows are only good for the snapshot and feedback model they were
+    // computed from
+    std::lock_guard lock(m_patterns_lock);
+    if (!m_patterns || (m_patterns->GetDictionary() != dict) ||
+        (m_patterns->GetFeedback().index() != m_feedback.index()))
+    {
+        auto store = std::make_shared<PatternStore>(dict, 0, 0, m_feedback);
+        const size_t matrix = store->GetRowBytes() * dict->GetWordCount();
+
+        // A cold row saves nearly as much work as a hot one in a fraction
+        // of the memory, so under a tight budget rows are kept compressed
+        // and the hot cache shrinks to a row per shard. The budget may
+        // shrink either later for something more valuable.
+        std::weak_ptr<PatternStore> weak = store;
+        const size_t hot = m_budget.Request("pattern rows (hot)", store->GetMinHotBytes(),
+            std::min(PatternStore::default_hot_bytes, store->GetFullHotBytes()), 1.0, false,
+            [weak](size_t bytes) { if (auto s = weak.lock()) s->SetHotLimit(bytes); });
+        store->SetHotLimit(hot);
+        const size_t cold = m_budget.Request("pattern rows (cold)", 0,
+            std::min(PatternStore::default_cold_bytes, matrix), 2.0, false,
+            [weak](size_t bytes) { if (auto s = weak.lock()) s->SetColdLimit(bytes); });
+        store->SetColdLimit(cold);
+
+        // The rows for a small enough word list are kept whole in the
+        // artifact cache, so later runs over the same words map them
+        // instead of computing any
+        if (m_cache && (matrix <= PatternStore::max_matrix_bytes)) {
+            MappedFile mapping;
+            const auto name = fmt::format("patterns-{}", GetFeedbackName(m_feedback));
+            auto build = [&dict, this](ImageWriter& out)
+                { PatternStore::WriteMatrix(*dict, m_feedback, out); };
+            if (m_cache->LookupOrBuild(name, PatternStore::matrix_version, dict->GetContentHash(),
+                    build, mapping) && store->AttachMatrix(mapping))
+            {
+                m_budget.RecordShared("pattern matrix", matrix);
+            }
+        }
+
+        // After an edit to the word list, most rows are still good
+        if (m_patterns)
+            store->Inherit(*m_patterns);
+        m_patterns = std::move(store);
+    }
+
+    return m_patterns;
+}
+
+/// Validate hints; prints a message and returns false if one is invalid
+bool mrdle::ValidateHints(const HintVect& hints, size_t word_size,
+    const AnyFeedback& feedback)
+{
+    for (auto&& [word,result] : hints) {
+        // word length must match the game word size, and result must be
+        // whatever the model's clues look like
+        const bool valid = (word.length() == word_size) &&
+            std::visit([&](auto model) { return model.ValidateClue(result, word_size); }, feedback);
+
+        if (!valid) {
+            fmt::print(std::cerr, "Invalid hint: {} {}\n", word, result);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// Set fails[w] bit h for every hint h that word w doesn't satisfy
+void mrdle::FindHintFailures(const Dictionary& dict, const HintVect& hints,
+    std::vector<uint64_t>& fails) const
+{
+    const auto& columns = dict.GetColumns();
+    const size_t n = dict.GetWordCount();
+    fails.assign(n, 0);
+
+    // Each hint compiles on its own (for Wordle, into letter masks and what
+    // each position allows), so a word is tested against every hint with a
+    // few lookups and the whole job is one pass over the words
+    std::visit([&]<FeedbackModel F>(F) {
+        std::vector<typename F::Matcher> matchers(hints.size());
+        uint64_t unsatisfiable = 0;
+        for (size_t h = 0; h < hints.size(); ++h) {
+            if (!matchers[h].Compile(columns, hints[h].first, hints[h].second))
+                unsatisfiable |= uint64_t(1) << h;
+        }
+
+        for (size_t w = 0; w < n; ++w) {
+            uint64_t f = unsatisfiable;
+            for (size_t h = 0; h < hints.size(); ++h) {
+                if (!((f >> h) & 1))
+                    f |= uint64_t(!matchers[h].Matches(w)) << h;
+            }
+            fails[w] = f;
+        }
+    }, m_feedback);
+}
+
+/// Set keep[w] for every word that satisfies the hints and query
+bool mrdle::FilterWords(const Dictionary& dict, const HintVect& hints,
+    std::string_view query, std::vector<uint8_t>& keep) const
+{
+    if (!ValidateHints(hints, dict.GetWordSize(), m_feedback))
+        return false;
+
+    const auto& columns = dict.GetColumns();
+
+    using clock = std::chrono::steady_clock;
+    const auto elapsed_us = [](clock::time_point start)
+        { return std::chrono::duration<double, std::micro>(clock::now() - start).count(); };
+    const auto count_kept = [](const std::vector<uint8_t>& keep)
+        { return static_cast<size_t>(std::count(keep.begin(), keep.end(), 1)); };
+
+    return std::visit([&]<FeedbackModel F>(F) {
+        // A model whose clues say where letters are merges the hints into
+        // letter domains first; contradictory hints are caught here,
+        // without looking at a single word
+        constexpr bool narrows = !std::is_same_v<typename F::Prefilter, NoPrefilter>;
+        auto t_start = clock::now();
+        typename F::Prefilter pre;
+        std::string error;
+        if (!pre.Compile(hints, dict.GetWordSize(), error)) {
+            fmt::print(std::cerr, "Contradictory hints: {}\n", error);
+            keep.assign(dict.GetWordCount(), 0);
+            return true;
+        }
+        const auto t_propagate = elapsed_us(t_start);
+
+        // Crossword-style query; compiled into a plan based on letter stats
+        t_start = clock::now();
+        WordQuery wq;
+        if (!wq.Compile(query, columns, error)) {
+            fmt::print(std::cerr, "Invalid query: {}\n", error);
+            return false;
+        }
+        keep.assign(dict.GetWordCount(), 1);
+        wq.Apply(columns, keep);
+        const auto t_query = elapsed_us(t_start);
+        const auto n_query = m_timings ? count_kept(keep) : 0;
+
+        // Most words fail a hint because they have a letter the hints ruled
+        // out or lack one that they require. Two mask ops per word weed
+        // those out.
+        t_start = clock::now();
+        pre.ApplyMasks(columns, keep);
+        const auto t_mask = elapsed_us(t_start);
+        const auto n_mask = m_timings ? count_kept(keep) : 0;
+
+        // Then a column scan per position whose domain rules out more
+        t_start = clock::now();
+        pre.ApplyColumns(columns, keep);
+        const auto t_columns = elapsed_us(t_start);
+        const auto n_columns = m_timings ? count_kept(keep) : 0;
+
+        // The domains are exact unless a hint has a character that isn't a
+        // letter or an unknown result (or the model has no domains); only
+        // then are the survivors checked against every clue
+        t_start = clock::now();
+        if (!pre.IsExact()) {
+            for (const auto& [hword, hres] : hints) {
+                typename F::Matcher matcher;
+                const bool satisfiable = matcher.Compile(columns, hword, hres);
+                for (size_t w = 0; w < keep.size(); ++w) {
+                    if (keep[w])
+                        keep[w] = satisfiable && matcher.Matches(w);
+                }
+            }
+        }
+        const auto t_check = elapsed_us(t_start);
+
+        if (m_timings) {
+            const auto n = dict.GetWordCount();
+            const auto n_check = count_kept(keep);
+            const auto pct = [n](size_t r) { return n ? 100.0 * r / n : 0.0; };
+            if (!wq.IsEmpty())
+                fmt::print(std::cerr, "Query plan:\n{}", wq.DescribePlan());
+            if (narrows && !hints.empty())
+                fmt::print(std::cerr, "{}", pre.Describe());
+            fmt::print(std::cerr, "Timings ({} words):\n", n);
+            if (narrows)
+                fmt::print(std::cerr, "  propagation:    {:10.1f} us\n", t_propagate);
+            fmt::print(std::cerr, "  query stage:    {:10.1f} us; rejected {} ({:.1f}%)\n",
+                t_query, n - n_query, pct(n - n_query));
+            if (narrows) {
+                fmt::print(std::cerr, "  mask stage:     {:10.1f} us; rejected {} ({:.1f}%)\n",
+                    t_mask, n_query - n_mask, pct(n_query - n_mask));
+                fmt::print(std::cerr, "  column stage:   {:10.1f} us; rejected {} ({:.1f}%)\n",
+                    t_columns, n_mask - n_columns, pct(n_mask - n_columns));
+            }
+            if (!pre.IsExact()) {
+                fmt::print(std::cerr, "  clue stage:     {:10.1f} us; checked {}, rejected {} ({:.1f}%)\n",
+                    t_check, n_columns, n_columns - n_check, pct(n_columns - n_check));
+            }
+        }
+
+        return true;
+    }, m_feedback);
+}
+
+/// List words (or, with suggest, suggest guesses) for each set of hints
+/// read from standard input
+int mrdle::ListWordsBatch(bool suggest)
+{
+    // Each input line is a list of "WORD HINT" pairs and each answer ends
+    // with an empty line. A reload can land between requests; each request
+    // sees a single dictionary snapshot. Suggestions share one pattern
+    // store, which carries its rows over to the next snapshot.
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream iss(line);
+        std::vector<std::string> tokens;
+        for (std::string token; iss >> token; )
+            tokens.push_back(std::move(token));
+
+        HintVect hints;
+        for (size_t t = 0; t + 1 < tokens.size(); t += 2)
+            hints.emplace_back(string_to_lower(tokens[t]), tokens[t + 1]);
+
+        if (tokens.size() % 2)
+            fmt::print(std::cerr, "Invalid hint: {}\n", tokens.back());
+        else if (suggest)
+            SuggestWords(hints);
+        else
+            ListWords(hints);
+
+        fmt::print("\n");
+        std::fflush(stdout);
+    }
 
     return 0;
 }
 
 // Determine if a word is a possible solution given a hint
-bool mrdle::CheckWordAgainstHint(const std::string& word, const HintPair& hint)
+bool mrdle::CheckWordAgainstHint(std::string_view word, const HintPair& hint)
 {
-    size_t c, ws = GetWordSize();
+    size_t c, ws = word.length();
 
     const std::string& hword = hint.first;
     const std::string& hres  = hint.second;
-    const auto npos = std::string::npos;
 
     for (size_t i=0; i<ws; ++i) {
         switch(hres[i]) {
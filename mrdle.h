@@ -13,7 +13,21 @@
 #include <cstdint>
 #include <vector>
 #include <string>
-#include <random>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <map>
+
+#include "artifact_cache.h"
+#include "letter_stats.h"
+#include "memory_budget.h"
+#include "pattern_store.h"
+#include "random_stream.h"
+#include "dictionary.h"
+#include "heuristic.h"
+#include "word_sets.h"
+#include "xordle.h"
 
 class mrdle {
 public:
@@ -22,11 +36,32 @@ public:
     using HintPair = std::pair<std::string, std::string>;
     /// A list of hints
     using HintVect = std::vector<HintPair>;
+    /// A set operation and the word file it applies to
+    using SetOpPair = std::pair<SetOperation, std::string>;
+    /// A list of set operations, applied in order
+    using SetOpVect = std::vector<SetOpPair>;
+
+    /// What ListWords says about the words the hints and query ruled out
+    enum class Explain {
+        None,       ///< Nothing
+        Counts,     ///< How many words each hint removed
+        Words,      ///< That, plus the hint that removed each word
+    };
+
+    /// What ListWords shows instead of the words; see SetLetterStatsMode
+    enum class LetterStatsMode {
+        None,       ///< The words
+        Table,      ///< Letter stats as a table
+        Json,       ///< Letter stats as JSON
+    };
 
     // -- Construction
 
-    /// Construct from a path to a word list file
-    mrdle(const std::string_view word_file = "");
+    /// Construct from a path to a word list file, optional dictionary image,
+    /// optional artifact cache directory and memory budget for derived data
+    mrdle(const std::string_view word_file = "", const std::string_view dict_image = "",
+        const std::string_view cache_dir = "", size_t memory_budget = MemoryBudget::unlimited);
+    ~mrdle();
 
     // -- Methods
 
@@ -34,34 +69,105 @@ public:
 
     /// Play a game of wordle in the current terminal
     bool TerminalPlay(std::string secret_word);
-    /// List words with optional hints to filter output
-    int ListWords(const HintVect& hints = HintVect());
+    /// List words with optional hints and query to filter output
+    int ListWords(const HintVect& hints = HintVect(), std::string_view query = {});
+    /// List words (or, with suggest, suggest guesses) for each set of hints
+    /// read from standard input
+    int ListWordsBatch(bool suggest = false);
+    /// Suggest the most informative guesses given optional hints and query
+    int SuggestWords(const HintVect& hints = HintVect(), std::string_view query = {},
+        size_t count = 10);
+    /// Play strategies (comma separated names, or "all") against the same
+    /// secrets and report how they compare; 0 games plays every word once
+    int RunTournament(std::string_view strategies, size_t games = 0, size_t threads = 0);
+    /// Find the most informative guess for the words that satisfy the hints
+    /// and query if any letter string were allowed
+    int FindAnyProbe(const HintVect& hints = HintVect(), std::string_view query = {},
+        size_t threads = 0);
+    /// List the pairs of words that share no letters and satisfy the hints
+    /// and query, each hint being the clue against both (Xordle)
+    int ListPairs(const HintVect& hints = HintVect(), std::string_view query = {});
+    /// Suggest the most informative guesses against those pairs
+    int SuggestPairs(const HintVect& hints = HintVect(), std::string_view query = {},
+        size_t count = 10, size_t threads = 0);
+    /// List families of words that differ in exactly one position
+    int FindTraps();
+    /// Search the heuristic strategy's weights by simulated games, starting
+    /// from weights_file if it exists and writing the best weights to it
+    int TuneWeights(size_t games = 0, size_t threads = 0, size_t evaluations = 100,
+        const std::string& weights_file = "");
+
+    /// Rebuild the dictionary from its source and swap it in
+    bool Reload();
+    /// Reload the dictionary whenever the word file changes or on SIGHUP
+    void EnableAutoReload();
+
+    /// Returns the current dictionary snapshot
+    std::shared_ptr<const Dictionary> GetDictionary() const noexcept
+        { return m_dict.load(); }
+
+    /// Returns the artifact cache, or nullptr if there isn't one
+    const ArtifactCache* GetArtifactCache() const noexcept { return m_cache.get(); }
+    /// Returns the memory budget that decides what derived data is kept
+    const MemoryBudget& GetMemoryBudget() const noexcept { return m_budget; }
 
     /// Returns total number of words in word list
-    size_t GetWordListCount() const noexcept { return m_words.size(); }
+    size_t GetWordListCount() const noexcept { return GetDictionary()->GetWordCount(); }
     /// Returns word size
-    size_t GetWordSize() const
-        { return m_words.empty() ? 0 : m_words[0].length(); }
+    size_t GetWordSize() const noexcept { return GetDictionary()->GetWordSize(); }
 
-    /// Returns a random word from the word list
-    const std::string& GetRandomWord() const;
+    /// Returns a random word from the word list; each call is a new game
+    std::string GetRandomWord() const;
+    /// Returns the random word for a game; depends only on the seed and game
+    std::string GetRandomWord(uint64_t game) const;
+    /// Combine a word list (the internal one if word_file is empty) with
+    /// other word files and write the result, as text or binary, to
+    /// output_file (standard output if empty). Reads only the words, so
+    /// it needs no mrdle instance.
+    static int CombineWordLists(std::string_view word_file, const SetOpVect& ops,
+        const std::string& output_file, bool binary, bool timings = false);
     /// Returns true if given word is in the word list
     bool IsWordInList(const std::string& word) const;
+    /// Returns the words in the word list closest to the given (non-)word
+    std::vector<std::string> GetSuggestions(std::string_view word,
+        size_t max_dist = 2, size_t max_count = 5) const;
 
     // Check a guessed word against the secret word
     bool CheckWordGuess(const std::string& secret_word, const std::string& guess_word,
         std::string& result);
     // Determine if a word is a possible solution given a hint
-    bool CheckWordAgainstHint(const std::string& word, const HintPair& hint);
+    static bool CheckWordAgainstHint(std::string_view word, const HintPair& hint);
 
     void SetNoColorMode(bool no_color) noexcept
         { m_no_color = no_color; }
+    void SetTimingsMode(bool timings) noexcept
+        { m_timings = timings; }
+    void SetExplainMode(Explain explain) noexcept
+        { m_explain = explain; }
+    /// Have ListWords (and so ListWordsBatch) show letter stats for the
+    /// words instead of the words; stats are cached by word set
+    void SetLetterStatsMode(LetterStatsMode mode) noexcept
+        { m_letter_stats = mode; }
+    /// Seed every random stream; the same seed replays the same games
+    void SetSeed(uint64_t seed) noexcept
+        { m_seed = seed; m_misc_stream = RandomStream(seed, misc_stream); }
+    uint64_t GetSeed() const noexcept { return m_seed; }
+    /// Set the rule for clues: the game's, --hint's and every solver's
+    void SetFeedback(const AnyFeedback& feedback) noexcept
+        { m_feedback = feedback; }
+    const AnyFeedback& GetFeedback() const noexcept { return m_feedback; }
+    /// Read the heuristic strategy's weights; prints a message on failure
+    bool LoadHeuristicWeights(const std::string& path);
+    /// Returns the random stream for a game (or any other numbered task)
+    RandomStream GetRandomStream(uint64_t game) const noexcept
+        { return RandomStream(m_seed, game); }
 
     // - Character result codes (res_*)
     static constexpr char res_matched = '!';    ///< Letter is in correct spot
     static constexpr char res_missing = 'x';    ///< Letter is not in word
     static constexpr char res_mislaid = '~';    ///< Letter is in the wrong spot
     static constexpr char res_unknown = ' ';    ///< Letter hasn't been processed yet
+    static constexpr char res_any     = '?';    ///< Letter's result isn't known (hints only)
 
     // - RGB color values for colorful guess results (color_*)
     static constexpr uint32_t color_matched = 0x00538D4E;   // Green
@@ -84,19 +190,71 @@ protected:
     /// Returns the string to use when player loses
     std::string_view GetLoseInsult() const;
 
-    /// Returns our pseudorandom number generator object
-    std::mt19937& GetPrngGenerator() const noexcept { return m_prng_gen; }
+    /// Stream for choices that aren't part of any game (e.g., insults)
+    static constexpr uint64_t misc_stream = UINT64_MAX;
 
-    /// Initialize word list from a file
-    void InitWordListFile(std::string_view word_file);
+    /// Load the word list and build (or attach to) a dictionary for it,
+    /// reusing what it can from base (the current dictionary) if given
+    std::shared_ptr<const Dictionary> LoadDictionary(const Dictionary* base = nullptr) const;
+    /// Ask the memory budget which optional dictionary indexes to build
+    Dictionary::Options PlanDictionary(size_t word_count, size_t word_size,
+        bool weighted) const;
+    /// Returns the pattern store for a dictionary snapshot
+    std::shared_ptr<PatternStore> GetPatternStore(const std::shared_ptr<const Dictionary>& dict);
+    /// Watcher thread body; see EnableAutoReload
+    void WatchWordList(std::stop_token stop);
+
+    /// Initialize word list (and word weights, if the file has any) from a file
+    static void InitWordListFile(std::string_view word_file, word_list& words,
+        Dictionary::Weights& weights);
     /// Initialize word list from internal word list
-    void InitWordListInternal();
+    static void InitWordListInternal(word_list& words);
+    /// Returns a value that changes whenever the word list source changes
+    static uint64_t GetWordListStamp(std::string_view word_file);
+
+    /// Validate hints; prints a message and returns false if one is invalid
+    static bool ValidateHints(const HintVect& hints, size_t word_size,
+        const AnyFeedback& feedback);
+    /// Explain which hints ruled out which words; see SetExplainMode
+    int ExplainWords(const Dictionary& dict, const HintVect& hints, std::string_view query);
+    /// Show letter stats for the words that satisfy the hints and query
+    int ShowLetterStats(const std::shared_ptr<const Dictionary>& dict, const HintVect& hints,
+        std::string_view query);
+    /// Set fails[w] bit h for every hint h that word w doesn't satisfy,
+    /// testing every compiled hint in one pass over the words; at most 64 hints
+    void FindHintFailures(const Dictionary& dict, const HintVect& hints,
+        std::vector<uint64_t>& fails) const;
+    /// Set keep[w] for every word that satisfies the hints and query
+    bool FilterWords(const Dictionary& dict, const HintVect& hints,
+        std::string_view query, std::vector<uint8_t>& keep) const;
+    /// Find the Xordle pairs for hints and query; prints a message and
+    /// returns false if they can't be searched
+    bool FilterPairs(const Dictionary& dict, const HintVect& hints,
+        std::string_view query, std::vector<WordPair>& pairs) const;
 
 private:
 
-    word_list               m_words;            ///< Set of all words
-    mutable std::mt19937    m_prng_gen;         ///< PRNG generator
+    std::string             m_word_file;        ///< Word list file; empty for internal
+    std::string             m_dict_image;       ///< Shared dictionary image file
+    std::unique_ptr<ArtifactCache>  m_cache;    ///< Derived data cache, if any
+    mutable MemoryBudget    m_budget;           ///< Decides what derived data is kept
+    /// Current dictionary snapshot; replaced as a whole on reload
+    std::atomic<std::shared_ptr<const Dictionary>>  m_dict;
+    std::jthread            m_watcher;          ///< Reloads m_dict on changes
+    std::mutex              m_patterns_lock;    ///< Guards m_patterns
+    std::shared_ptr<PatternStore>   m_patterns; ///< Pattern rows for m_dict
+    std::mutex              m_letter_stats_lock;    ///< Guards the two below
+    std::shared_ptr<LetterStatsCache>   m_letter_stats_cache;   ///< Created on first use
+    std::weak_ptr<const Dictionary>     m_letter_stats_dict;    ///< What the cache counted
+    uint64_t                m_seed;             ///< Seed of every random stream
+    mutable std::atomic<uint64_t>   m_next_game{0}; ///< Game for GetRandomWord()
+    mutable RandomStream    m_misc_stream;      ///< See misc_stream
+    AnyFeedback             m_feedback;         ///< Rule for clues; Wordle's by default
+    HeuristicWeights        m_heuristic_weights{default_heuristic_weights};
     bool                    m_no_color{false};  ///< Don't use colorized output
+    bool                    m_timings{false};   ///< Report timings to stderr
+    Explain                 m_explain{Explain::None};   ///< See ListWords
+    LetterStatsMode         m_letter_stats{LetterStatsMode::None};  ///< See ListWords
 };
 
 
@@ -0,0 +1,131 @@
+/**
+ * @file    packed_words.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares PackedWords; a view of fixed length words packed end to end
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef packed_words__header_included
+#define packed_words__header_included
+
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <span>
+
+#include "dict_image.h"
+
+/**
+ * @brief A sorted list of same-length words stored as one block of letters
+ *
+ * Word i occupies letters [i * size, (i + 1) * size). The letters live in
+ * a dictionary image; this class is just a view of them.
+ */
+class PackedWords {
+public:
+
+    PackedWords() = default;
+
+    /// View packed letters that hold words of the given size
+    PackedWords(std::span<const char> letters, size_t word_size) noexcept
+        : m_letters(letters), m_word_size(word_size),
+          m_count(word_size ? letters.size() / word_size : 0) {}
+
+    /// Returns the number of words
+    size_t size() const noexcept { return m_count; }
+    /// Returns true if there are no words
+    bool empty() const noexcept { return 0 == m_count; }
+    /// Returns the length of each word
+    size_t GetWordSize() const noexcept { return m_word_size; }
+    /// Returns all letters of all words
+    std::span<const char> GetLetters() const noexcept { return m_letters; }
+
+    /// Returns word i
+    std::string_view operator[](size_t i) const noexcept
+        { return {m_letters.data() + i * m_word_size, m_word_size}; }
+
+    /// Returns the index of word, or size() if it's not in the list
+    size_t Find(std::string_view word) const noexcept
+    {
+        if (word.length() != m_word_size)
+            return m_count;
+
+        // Words are sorted; use a binary search to find it
+        size_t lo = 0, hi = m_count;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if ((*this)[mid] < word)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return ((lo < m_count) && ((*this)[lo] == word)) ? lo : m_count;
+    }
+
+    /// Marks a word in MapFrom's result that isn't in the base list
+    static constexpr uint32_t no_word = UINT32_MAX;
+
+    /// Returns, for each word, its index in base or no_word if it isn't
+    /// there; both lists must be sorted
+    std::vector<uint32_t> MapFrom(const PackedWords& base) const
+    {
+        std::vector<uint32_t> map(m_count, no_word);
+        if (base.GetWordSize() != m_word_size)
+            return map;
+
+        // Merge the two sorted lists
+        size_t b = 0;
+        for (size_t i = 0; i < m_count; ++i) {
+            const auto word = (*this)[i];
+            while ((b < base.size()) && (base[b] < word))
+                ++b;
+            if ((b < base.size()) && (base[b] == word))
+                map[i] = static_cast<uint32_t>(b++);
+        }
+
+        return map;
+    }
+
+    /// Pack a list of same-length words end to end
+    static std::vector<char> Pack(const std::vector<std::string>& words)
+    {
+        std::vector<char> letters;
+        letters.reserve(words.size() * (words.empty() ? 0 : words[0].length()));
+        for (const auto& w : words)
+            letters.insert(letters.end(), w.begin(), w.end());
+
+        return letters;
+    }
+
+    /// Write the words to an image
+    void Save(ImageWriter& out) const
+    {
+        out.WriteValue(m_word_size);
+        out.Write(m_letters);
+    }
+
+    /// Load a view of words written by Save
+    bool Load(ImageReader& in) noexcept
+    {
+        uint64_t word_size;
+        std::span<const char> letters;
+        if (!in.ReadValue(word_size) || !in.Read(letters))
+            return false;
+        if (word_size ? (letters.size() % word_size) : !letters.empty())
+            return false;
+
+        *this = PackedWords(letters, static_cast<size_t>(word_size));
+        return true;
+    }
+
+private:
+
+    std::span<const char>   m_letters;          ///< All letters of all words
+    size_t                  m_word_size{0};     ///< Letters per word
+    size_t                  m_count{0};         ///< Number of words
+};
+
+#endif // ifndef packed_words__header_included
@@ -0,0 +1,314 @@
+/**
+ * @file    pattern_store.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements PatternStore; a lazily computed guess x secret pattern matrix
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <tuple>
+#include <bit>
+
+#include "pattern_store.h"
+
+PatternStore::PatternStore(std::shared_ptr<const Dictionary> dict,
+    size_t hot_bytes, size_t cold_bytes, AnyFeedback feedback)
+    : m_dict(std::move(dict)), m_feedback(feedback),
+      m_hot_limit(hot_bytes / shard_count), m_cold_limit(cold_bytes / shard_count)
+{
+}
+
+/// Returns the row for the given guess (index into the dictionary)
+PatternStore::RowPtr PatternStore::GetRow(uint32_t guess)
+{
+    Shard& shard = m_shards[guess % shard_count];
+
+    {
+        std::lock_guard lock(shard.lock);
+
+        auto hit = shard.hot.find(guess);
+        if (hit != shard.hot.end()) {
+            if (!hit->second.pinned)
+                shard.hot_lru.splice(shard.hot_lru.begin(), shard.hot_lru, hit->second.lru);
+            ++shard.stats.hits;
+            return hit->second.row;
+        }
+
+        auto cold = shard.cold.find(guess);
+        if (cold != shard.cold.end()) {
+            auto row = std::make_shared<const Row>(Unpack(cold->second.row, m_dict->GetWordCount()));
+            shard.cold_bytes -= cold->second.row.GetBytes();
+            shard.cold_lru.erase(cold->second.lru);
+            shard.cold.erase(cold);
+            InsertHot(shard, guess, row, false);
+            ++shard.stats.decodes;
+            return row;
+        }
+    }
+
+    // Copy or compute the row without holding the lock
+    const size_t count = m_dict->GetWordCount();
+    std::shared_ptr<Row> row;
+    if (!m_matrix.empty())
+        row = std::make_shared<Row>(m_matrix.begin() + guess * count, m_matrix.begin() + (guess + 1) * count);
+    else {
+        row = std::make_shared<Row>(count);
+        std::visit([&](auto model) { model.ComputeRow(m_dict->GetColumns(), m_dict->GetWord(guess), *row); },
+            m_feedback);
+    }
+
+    std::lock_guard lock(shard.lock);
+    auto raced = shard.hot.find(guess);
+    if (raced != shard.hot.end())
+        return raced->second.row;       // Another thread beat us to it
+
+    InsertHot(shard, guess, row, false);
+    ++(m_matrix.empty() ? shard.stats.computes : shard.stats.loads);
+    return row;
+}
+
+/// Keep the row for the given guess hot for the life of the store
+void PatternStore::Pin(uint32_t guess)
+{
+    auto row = GetRow(guess);
+
+    Shard& shard = m_shards[guess % shard_count];
+    std::lock_guard lock(shard.lock);
+
+    auto it = shard.hot.find(guess);
+    if (it == shard.hot.end())
+        InsertHot(shard, guess, row, true);
+    else if (!it->second.pinned) {
+        shard.hot_lru.erase(it->second.lru);
+        it->second.pinned = true;
+    }
+}
+
+/// Write the matrix of every row for a dictionary and feedback model
+void PatternStore::WriteMatrix(const Dictionary& dict, const AnyFeedback& feedback, ImageWriter& out)
+{
+    const size_t count = dict.GetWordCount();
+    std::vector<Pattern> matrix(count * count);
+    std::visit([&](auto model) {
+        for (size_t g = 0; g < count; ++g) {
+            model.ComputeRow(dict.GetColumns(), dict.GetWord(g),
+                std::span<Pattern>(matrix.data() + g * count, count));
+        }
+    }, feedback);
+
+    out.WriteValue(count);
+    out.WriteValue(dict.GetContentHash());
+    out.Write(std::span<const Pattern>(matrix));
+}
+
+/// Serve rows from a matrix written by WriteMatrix, taking over the mapping
+bool PatternStore::AttachMatrix(MappedFile& mapping)
+{
+    ImageReader in(mapping.GetData());
+    uint64_t count = 0, hash = 0;
+    std::span<const Pattern> matrix;
+    in.ReadValue(count);
+    in.ReadValue(hash);
+    in.Read(matrix);
+    if (!in.IsOk() || (count != m_dict->GetWordCount()) || (hash != m_dict->GetContentHash()) ||
+        (matrix.size() != count * count))
+    {
+        return false;
+    }
+
+    m_matrix_file.Swap(mapping);
+    m_matrix = matrix;
+    return true;
+}
+
+/// Carry over the hot rows of a store for an earlier version of the word list
+void PatternStore::Inherit(const PatternStore& base)
+{
+    const auto& words = m_dict->GetWords();
+    const auto& base_words = base.m_dict->GetWords();
+    if ((words.GetWordSize() != base_words.GetWordSize()) ||
+        (words.GetWordSize() > max_pattern_word_size) ||
+        (m_feedback.index() != base.m_feedback.index()))
+    {
+        return;
+    }
+
+    // Where each word came from, and where each base word went
+    const auto from_base = words.MapFrom(base_words);
+    std::vector<uint32_t> to_new(base_words.size(), PackedWords::no_word);
+    std::vector<uint32_t> added;
+    for (uint32_t w = 0; w < from_base.size(); ++w) {
+        if (from_base[w] != PackedWords::no_word)
+            to_new[from_base[w]] = w;
+        else
+            added.push_back(w);
+    }
+
+    for (const auto& base_shard : base.m_shards) {
+
+        // Take references to the rows so the base isn't held up while we
+        // remap them. Cold rows are left behind; they'd have to be decoded.
+        std::vector<std::tuple<uint32_t, RowPtr, bool>> rows;
+        {
+            std::lock_guard lock(base_shard.lock);
+            for (const auto& [guess, entry] : base_shard.hot) {
+                if (to_new[guess] != PackedWords::no_word)
+                    rows.emplace_back(guess, entry.row, entry.pinned);
+            }
+        }
+
+        for (const auto& [base_guess, base_row_ptr, pinned] : rows) {
+            const uint32_t guess = to_new[base_guess];
+            const auto guess_word = words[guess];
+            const Row& base_row = *base_row_ptr;
+
+            auto row = std::make_shared<Row>(words.size());
+            for (size_t s = 0; s < row->size(); ++s) {
+                if (from_base[s] != PackedWords::no_word)
+                    (*row)[s] = base_row[from_base[s]];
+            }
+            std::visit([&](auto model) {
+                for (auto s : added)
+                    (*row)[s] = model.Compute(words[s], guess_word);
+            }, m_feedback);
+
+            Shard& shard = m_shards[guess % shard_count];
+            std::lock_guard lock(shard.lock);
+            if (!shard.hot.contains(guess)) {
+                InsertHot(shard, guess, std::move(row), pinned);
+                ++shard.stats.inherited;
+            }
+        }
+    }
+}
+
+/// Returns cache statistics
+PatternStore::Stats PatternStore::GetStats() const
+{
+    Stats total;
+    for (const auto& shard : m_shards) {
+        std::lock_guard lock(shard.lock);
+        total.hits       += shard.stats.hits;
+        total.decodes    += shard.stats.decodes;
+        total.computes   += shard.stats.computes;
+        total.loads      += shard.stats.loads;
+        total.inherited  += shard.stats.inherited;
+        total.hot_rows   += shard.hot.size();
+        total.hot_bytes  += shard.hot_bytes;
+        total.cold_rows  += shard.cold.size();
+        total.cold_bytes += shard.cold_bytes;
+    }
+
+    return total;
+}
+
+/// Add a row to the hot cache of a shard; shard must be locked
+void PatternStore::InsertHot(Shard& shard, uint32_t guess, RowPtr row, bool pinned)
+{
+    HotEntry entry{std::move(row), shard.hot_lru.end(), pinned};
+    if (!pinned)
+        entry.lru = shard.hot_lru.insert(shard.hot_lru.begin(), guess);
+    shard.hot.emplace(guess, std::move(entry));
+    shard.hot_bytes += GetRowBytes();
+
+    Trim(shard);
+}
+
+/// Change the size of the hot cache, demoting rows as needed
+void PatternStore::SetHotLimit(size_t bytes)
+{
+    m_hot_limit = bytes / shard_count;
+    for (auto& shard : m_shards) {
+        std::lock_guard lock(shard.lock);
+        Trim(shard);
+    }
+}
+
+/// Change the size of the cold cache, evicting rows as needed
+void PatternStore::SetColdLimit(size_t bytes)
+{
+    m_cold_limit = bytes / shard_count;
+    for (auto& shard : m_shards) {
+        std::lock_guard lock(shard.lock);
+        Trim(shard);
+    }
+}
+
+/// Demote and evict rows until a shard fits its limits; shard must be locked
+void PatternStore::Trim(Shard& shard)
+{
+    const size_t hot_limit  = m_hot_limit;
+    const size_t cold_limit = m_cold_limit;
+
+    // Demote least recently used rows to the cold cache. Pinned rows are
+    // not on the LRU list, so they never get here.
+    while ((shard.hot_bytes > hot_limit) && !shard.hot_lru.empty()) {
+        const uint32_t victim = shard.hot_lru.back();
+        shard.hot_lru.pop_back();
+        auto it = shard.hot.find(victim);
+
+        PackedRow packed = Pack(*it->second.row);
+        shard.hot.erase(it);
+        shard.hot_bytes -= GetRowBytes();
+
+        if (packed.GetBytes() <= cold_limit) {
+            shard.cold_bytes += packed.GetBytes();
+            auto lru = shard.cold_lru.insert(shard.cold_lru.begin(), victim);
+            shard.cold.emplace(victim, ColdEntry{std::move(packed), lru});
+        }
+    }
+
+    // Rows that fall out of the cold cache are recomputed on demand
+    while ((shard.cold_bytes > cold_limit) && !shard.cold_lru.empty()) {
+        auto it = shard.cold.find(shard.cold_lru.back());
+        shard.cold_bytes -= it->second.row.GetBytes();
+        shard.cold.erase(it);
+        shard.cold_lru.pop_back();
+    }
+}
+
+PatternStore::PackedRow PatternStore::Pack(const Row& row)
+{
+    PackedRow packed;
+
+    // Map each distinct pattern to its palette index
+    std::unordered_map<Pattern, uint32_t> index;
+    for (Pattern p : row) {
+        if (index.emplace(p, static_cast<uint32_t>(packed.palette.size())).second)
+            packed.palette.push_back(p);
+    }
+
+    packed.width = packed.palette.size() > 1 ?
+        static_cast<uint32_t>(std::bit_width(packed.palette.size() - 1)) : 0;
+    packed.bits.assign((row.size() * packed.width + 63) / 64, 0);
+
+    size_t bit = 0;
+    for (Pattern p : row) {
+        const uint64_t v = index[p];
+        packed.bits[bit / 64] |= v << (bit % 64);
+        if ((bit % 64) + packed.width > 64)
+            packed.bits[bit / 64 + 1] |= v >> (64 - bit % 64);
+        bit += packed.width;
+    }
+
+    return packed;
+}
+
+PatternStore::Row PatternStore::Unpack(const PackedRow& packed, size_t count)
+{
+    if (0 == packed.width)
+        return Row(count, packed.palette.empty() ? Pattern(0) : packed.palette[0]);
+
+    Row row(count);
+    const uint64_t mask = (uint64_t(1) << packed.width) - 1;
+
+    size_t bit = 0;
+    for (size_t i = 0; i < count; ++i, bit += packed.width) {
+        uint64_t v = packed.bits[bit / 64] >> (bit % 64);
+        if ((bit % 64) + packed.width > 64)
+            v |= packed.bits[bit / 64 + 1] << (64 - bit % 64);
+        row[i] = packed.palette[v & mask];
+    }
+
+    return row;
+}
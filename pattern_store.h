@@ -0,0 +1,172 @@
+/**
+ * @file    pattern_store.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares PatternStore; a lazily computed guess x secret pattern matrix
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef pattern_store__header_included
+#define pattern_store__header_included
+
+#include <unordered_map>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <array>
+#include <mutex>
+#include <list>
+#include <span>
+
+#include "dictionary.h"
+#include "feedback.h"
+
+/**
+ * @brief The pattern of every guess against every secret, one row at a time
+ *
+ * A full pattern matrix is |words| x |words| patterns, which doesn't fit
+ * in memory for large word lists. Instead, a row (one guess against every
+ * secret) is computed when it's first asked for and then cached:
+ *  - Hot rows are kept decoded in an LRU cache.
+ *  - Rows that fall out of the hot cache are compressed (palette plus
+ *    bit-packed indices) into a larger cold LRU cache.
+ *  - Rows that fall out of both are simply recomputed when needed.
+ *
+ * Rows are computed by the feedback model's own loop, chosen once per row.
+ * A store may instead serve rows from a whole matrix kept in the artifact
+ * cache (see WriteMatrix), so runs over the same words never compute one.
+ * Pinned rows (e.g., common openers) are never evicted. The caches are
+ * sharded by guess so that threads rarely contend for a lock. When the
+ * word list is edited, the new store inherits the old store's hot rows,
+ * computing only the patterns against added words.
+ */
+class PatternStore {
+public:
+
+    /// Patterns of one guess against every word in the dictionary
+    using Row    = std::vector<Pattern>;
+    using RowPtr = std::shared_ptr<const Row>;
+
+    /// Cache statistics
+    struct Stats {
+        size_t  hits{0};            ///< Rows found in the hot cache
+        size_t  decodes{0};         ///< Rows decoded from the cold cache
+        size_t  computes{0};        ///< Rows computed from scratch
+        size_t  loads{0};           ///< Rows copied from the attached matrix
+        size_t  inherited{0};       ///< Rows carried over from an earlier store
+        size_t  hot_rows{0};        ///< Rows in the hot cache
+        size_t  hot_bytes{0};       ///< Bytes used by the hot cache
+        size_t  cold_rows{0};       ///< Rows in the cold cache
+        size_t  cold_bytes{0};      ///< Bytes used by the cold cache
+    };
+
+    static constexpr size_t default_hot_bytes  = size_t(64) << 20;
+    static constexpr size_t default_cold_bytes = size_t(128) << 20;
+    /// Largest matrix (every row) worth keeping as an artifact
+    static constexpr size_t max_matrix_bytes = size_t(64) << 20;
+    /// Bump whenever the layout of the matrix image changes
+    static constexpr uint64_t matrix_version = 1;
+
+    // -- Construction
+
+    PatternStore(std::shared_ptr<const Dictionary> dict,
+        size_t hot_bytes = default_hot_bytes, size_t cold_bytes = default_cold_bytes,
+        AnyFeedback feedback = WordleFeedback());
+
+    // -- Methods
+
+    /// Returns the row for the given guess (index into the dictionary)
+    RowPtr GetRow(uint32_t guess);
+    /// Keep the row for the given guess hot for the life of the store
+    void Pin(uint32_t guess);
+
+    /// Write the matrix of every row for a dictionary and feedback model
+    static void WriteMatrix(const Dictionary& dict, const AnyFeedback& feedback, ImageWriter& out);
+    /// Serve rows from a matrix written by WriteMatrix, taking over the
+    /// mapping; fails if it isn't for this store's dictionary
+    bool AttachMatrix(MappedFile& mapping);
+
+    /// Carry over the hot rows of a store for an earlier version of the
+    /// word list; only patterns against added words are computed. Does
+    /// nothing if the stores use different feedback models.
+    void Inherit(const PatternStore& base);
+
+    /// Change the size of the hot cache, demoting rows as needed
+    void SetHotLimit(size_t bytes);
+    /// Change the size of the cold cache, evicting rows as needed
+    void SetColdLimit(size_t bytes);
+    /// Returns the bytes used by a decoded row
+    size_t GetRowBytes() const noexcept { return m_dict->GetWordCount() * sizeof(Pattern); }
+    /// Returns the bytes used by every row
+    size_t GetMatrixBytes() const noexcept { return GetRowBytes() * m_dict->GetWordCount(); }
+    /// Returns the smallest hot cache that can hold a row in every shard
+    size_t GetMinHotBytes() const noexcept { return GetRowBytes() * shard_count; }
+    /// Returns the smallest hot cache that can hold every row; rows are
+    /// split across shards by index, so the fullest shard sets the size
+    size_t GetFullHotBytes() const noexcept
+        { return GetMinHotBytes() * ((m_dict->GetWordCount() + shard_count - 1) / shard_count); }
+
+    /// Returns the dictionary that the rows are for
+    const std::shared_ptr<const Dictionary>& GetDictionary() const noexcept { return m_dict; }
+    /// Returns the feedback model that the rows are for
+    const AnyFeedback& GetFeedback() const noexcept { return m_feedback; }
+    /// Returns the number of distinct patterns a row may hold
+    size_t GetPatternCount() const noexcept
+        { return ::GetPatternCount(m_feedback, m_dict->GetWordSize()); }
+    /// Returns cache statistics
+    Stats GetStats() const;
+
+private:
+
+    /// A row compressed to a palette of its distinct patterns
+    struct PackedRow {
+        std::vector<Pattern>    palette;        ///< Distinct patterns in the row
+        std::vector<uint64_t>   bits;           ///< Palette index of each secret
+        uint32_t                width{0};       ///< Bits per palette index
+
+        size_t GetBytes() const noexcept
+            { return palette.size() * sizeof(Pattern) + bits.size() * sizeof(uint64_t); }
+    };
+
+    static PackedRow Pack(const Row& row);
+    static Row Unpack(const PackedRow& packed, size_t count);
+
+    struct HotEntry {
+        RowPtr                          row;
+        std::list<uint32_t>::iterator   lru;
+        bool                            pinned{false};
+    };
+    struct ColdEntry {
+        PackedRow                       row;
+        std::list<uint32_t>::iterator   lru;
+    };
+
+    struct Shard {
+        mutable std::mutex                      lock;
+        std::unordered_map<uint32_t, HotEntry>  hot;
+        std::list<uint32_t>                     hot_lru;    ///< Most recent first
+        std::unordered_map<uint32_t, ColdEntry> cold;
+        std::list<uint32_t>                     cold_lru;   ///< Most recent first
+        size_t                                  hot_bytes{0};
+        size_t                                  cold_bytes{0};
+        Stats                                   stats;
+    };
+
+    /// Add a row to the hot cache of a shard; shard must be locked
+    void InsertHot(Shard& shard, uint32_t guess, RowPtr row, bool pinned);
+    /// Demote and evict rows until a shard fits its limits; shard must be locked
+    void Trim(Shard& shard);
+
+    static constexpr size_t shard_count = 16;
+
+    std::shared_ptr<const Dictionary>   m_dict;             ///< Words the rows are for
+    AnyFeedback                         m_feedback;         ///< Rule the rows follow
+    MappedFile                          m_matrix_file;      ///< Attached matrix, if any
+    std::span<const Pattern>            m_matrix;           ///< Every row, in m_matrix_file
+    std::atomic<size_t>                 m_hot_limit;        ///< Hot bytes per shard
+    std::atomic<size_t>                 m_cold_limit;       ///< Cold bytes per shard
+    std::array<Shard, shard_count>      m_shards;
+};
+
+#endif // ifndef pattern_store__header_included
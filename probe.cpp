@@ -0,0 +1,299 @@
+/**
+ * @file    probe.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements ProbeSearch; finds the most informative letter string
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <array>
+#include <cmath>
+
+#include "feedback.h"
+#include "probe.h"
+
+/// Slack for rounding when comparing a bound with a score; a bound must
+/// fall clearly below the best score to prune
+static constexpr double bound_slack = 1e-9;
+
+/// Entropy (bits) of a split into groups, given the sum of n * log2(n)
+/// over the group sizes n and the total
+static double GetSplitBits(double sum_nlogn, double total) noexcept
+{
+    return (total > 0) ? std::log2(total) - sum_nlogn / total : 0;
+}
+
+struct ProbeSearch::Search {
+    std::string                         probe;  ///< String being built
+    std::vector<std::vector<uint32_t>>  order;  ///< By depth: candidates, grouped
+    std::vector<std::vector<uint32_t>>  ends;   ///< By depth: end of each group in order
+    std::vector<double>                 bits;   ///< By depth: entropy of the groups
+    std::vector<uint32_t>               used;   ///< By depth: letters in the prefix
+    std::vector<uint32_t>               hist;
+    std::vector<Pattern>                touched;
+    uint64_t                            scored{0};
+    uint64_t                            visited{0};
+};
+
+ProbeSearch::ProbeSearch(const Dictionary& dict, std::span<const uint32_t> candidates)
+    : m_dict(dict), m_word_size(dict.GetWordSize())
+{
+    for (auto c : candidates)
+        m_words.emplace_back(dict.GetWord(c));
+    const size_t n = m_words.size();
+    const double total = static_cast<double>(n);
+    m_max_bits = n ? std::log2(total) : 0;
+
+    // Letter counts, and the letters that any candidate has
+    m_counts.assign(n * 26, 0);
+    uint32_t present = 0;
+    for (size_t c = 0; c < n; ++c) {
+        for (char ch : m_words[c]) {
+            if (WordColumns::LetterBit(ch)) {
+                ++m_counts[c * 26 + (ch - 'a')];
+                present |= WordColumns::LetterBit(ch);
+            }
+        }
+    }
+
+    // Missing letters are interchangeable, so try only the first
+    bool have_missing = false;
+    for (char ch = 'a'; ch <= 'z'; ++ch) {
+        if ((present & WordColumns::LetterBit(ch)) || !have_missing) {
+            have_missing |= !(present & WordColumns::LetterBit(ch));
+            m_letters += ch;
+        }
+    }
+
+    // The most a letter can say about a position (match or not), and the
+    // most the count of each letter can say
+    std::vector<double> position_bits(m_word_size, 0);
+    for (size_t p = 0; p < m_word_size; ++p) {
+        std::array<uint32_t, 26> at{};
+        for (const auto& w : m_words) {
+            if (WordColumns::LetterBit(w[p]))
+                ++at[w[p] - 'a'];
+        }
+        for (auto k : at) {
+            const double nlogn = (k ? k * std::log2(k) : 0) +
+                ((n - k) ? (n - k) * std::log2(double(n - k)) : 0);
+            position_bits[p] = std::max(position_bits[p], GetSplitBits(nlogn, total));
+        }
+    }
+    std::vector<double> count_bits(26, 0);
+    for (int l = 0; l < 26; ++l) {
+        std::array<uint32_t, max_pattern_word_size + 1> by_count{};
+        for (size_t c = 0; c < n; ++c)
+            ++by_count[std::min<size_t>(m_counts[c * 26 + l], max_pattern_word_size)];
+        double nlogn = 0;
+        for (auto k : by_count)
+            nlogn += k ? k * std::log2(k) : 0;
+        count_bits[l] = GetSplitBits(nlogn, total);
+    }
+    std::sort(count_bits.begin(), count_bits.end(), std::greater<double>());
+
+    // Positions d.. of a string can say no more than their positions and
+    // their (at most word size - d) distinct letters' counts
+    m_rest_bound.assign(m_word_size + 1, 0);
+    double positions = 0, letters = 0;
+    for (size_t d = m_word_size; d--; ) {
+        positions += position_bits[d];
+        letters += count_bits[m_word_size - 1 - d];
+        m_rest_bound[d] = positions + letters;
+    }
+}
+
+/// Returns the number of strings there are to search
+uint64_t ProbeSearch::GetStringCount() const noexcept
+{
+    uint64_t count = 1;
+    for (size_t i = 0; i < m_word_size; ++i)
+        count *= 26;
+    return count;
+}
+
+/// Entropy and number of groups of the clues for probe
+double ProbeSearch::Score(std::string_view probe, size_t* groups, std::vector<uint32_t>& hist,
+    std::vector<Pattern>& touched) const
+{
+    for (const auto& w : m_words) {
+        const Pattern p = WordleFeedback::Compute(w, probe);
+        if (0 == hist[p]++)
+            touched.push_back(p);
+    }
+
+    double nlogn = 0;
+    for (auto p : touched) {
+        nlogn += hist[p] * std::log2(hist[p]);
+        hist[p] = 0;
+    }
+    if (groups)
+        *groups = touched.size();
+    touched.clear();
+
+    return GetSplitBits(nlogn, static_cast<double>(m_words.size()));
+}
+
+/// Offer a string as the best found; ties go to the alphabetically first
+void ProbeSearch::Offer(double bits, const std::string& probe)
+{
+    std::lock_guard lock(m_best_lock);
+    const double best = m_best_bits;
+    if ((bits > best) || ((bits == best) && (probe < m_best))) {
+        m_best = probe;
+        m_best_bits = bits;
+    }
+}
+
+/// Split level d's groups by letter at position d into level d + 1
+double ProbeSearch::Refine(Search& s, size_t d, char letter) const
+{
+    // Candidates split by whether they have the letter here and, the first
+    // time the prefix has the letter, by how many of it they have
+    const int l = letter - 'a';
+    const bool first = !(s.used[d] & WordColumns::LetterBit(letter));
+    const size_t key_count = 2 * (max_pattern_word_size + 1);
+
+    const auto& in = s.order[d];
+    auto& out = s.order[d + 1];
+    auto& out_ends = s.ends[d + 1];
+    out_ends.clear();
+
+    double nlogn = 0;
+    uint32_t begin = 0;
+    for (uint32_t end : s.ends[d]) {
+        std::array<uint32_t, key_count> count{};
+        auto key = [&](uint32_t c) {
+            return (m_words[c][d] == letter) + (first ? 2 * m_counts[c * 26 + l] : 0);
+        };
+        for (uint32_t i = begin; i < end; ++i)
+            ++count[key(in[i])];
+
+        std::array<uint32_t, key_count> at;
+        uint32_t next = begin;
+        for (size_t k = 0; k < key_count; ++k) {
+            at[k] = next;
+            if (count[k]) {
+                next += count[k];
+                out_ends.push_back(next);
+                nlogn += count[k] * std::log2(count[k]);
+            }
+        }
+        for (uint32_t i = begin; i < end; ++i)
+            out[at[key(in[i])]++] = in[i];
+
+        begin = end;
+    }
+
+    s.used[d + 1] = s.used[d] | WordColumns::LetterBit(letter);
+    return s.bits[d + 1] = GetSplitBits(nlogn, static_cast<double>(m_words.size()));
+}
+
+/// Search below depth d of s (a prefix of length d)
+void ProbeSearch::SearchFrom(Search& s, size_t d)
+{
+    if (d == m_word_size) {
+        // The clue is a function of the signature, so it can say no more
+        if (s.bits[d] < m_best_bits - bound_slack)
+            return;
+        ++s.scored;
+        Offer(Score(s.probe, nullptr, s.hist, s.touched), s.probe);
+        return;
+    }
+
+    for (char letter : m_letters) {
+        ++s.visited;
+        s.probe[d] = letter;
+        const double bound = std::min(m_max_bits, Refine(s, d, letter) + m_rest_bound[d + 1]);
+        if (bound >= m_best_bits - bound_slack)
+            SearchFrom(s, d + 1);
+    }
+}
+
+/// Search the strings starting with prefix
+void ProbeSearch::SearchPrefix(Search& s, const std::string& prefix)
+{
+    for (size_t d = 0; d < prefix.length(); ++d) {
+        ++s.visited;
+        s.probe[d] = prefix[d];
+        const double bound = std::min(m_max_bits, Refine(s, d, prefix[d]) + m_rest_bound[d + 1]);
+        if (bound < m_best_bits - bound_slack)
+            return;
+    }
+    SearchFrom(s, prefix.length());
+}
+
+/// Search every string; threads 0 for one per core
+ProbeSearch::Result ProbeSearch::Run(size_t threads)
+{
+    Result result;
+    if (m_words.empty() || !m_word_size)
+        return result;
+
+    std::vector<uint32_t> hist(WordleFeedback::GetPatternCount(m_word_size), 0);
+    std::vector<Pattern> touched;
+
+    // Start from the best word; only strings that might beat it are searched
+    for (uint32_t w = 0; w < m_dict.GetWordCount(); ++w) {
+        const std::string word(m_dict.GetWord(w));
+        size_t groups = 0;
+        const double bits = Score(word, &groups, hist, touched);
+        if (result.word.empty() || (bits > result.word_bits)) {
+            result.word = word;
+            result.word_bits = bits;
+            result.word_groups = groups;
+        }
+    }
+    m_best = result.word;
+    m_best_bits = result.word_bits;
+
+    // Threads take two-letter prefixes in turn
+    std::vector<std::string> prefixes{""};
+    for (size_t d = 0; d < std::min<size_t>(2, m_word_size); ++d) {
+        std::vector<std::string> longer;
+        for (const auto& prefix : prefixes) {
+            for (char letter : m_letters)
+                longer.push_back(prefix + letter);
+        }
+        prefixes.swap(longer);
+    }
+
+    size_t thread_count = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::min(thread_count, prefixes.size());
+
+    const uint32_t n = static_cast<uint32_t>(m_words.size());
+    std::atomic<size_t> next_prefix{0};
+    std::atomic<uint64_t> scored{0}, visited{0};
+    auto worker = [&]() {
+        Search s;
+        s.probe.assign(m_word_size, m_letters[0]);
+        s.order.assign(m_word_size + 1, std::vector<uint32_t>(n));
+        s.ends.resize(m_word_size + 1);
+        s.bits.assign(m_word_size + 1, 0);
+        s.used.assign(m_word_size + 1, 0);
+        s.hist.assign(WordleFeedback::GetPatternCount(m_word_size), 0);
+        for (uint32_t c = 0; c < n; ++c)
+            s.order[0][c] = c;
+        s.ends[0] = {n};
+
+        for (size_t i; (i = next_prefix++) < prefixes.size(); )
+            SearchPrefix(s, prefixes[i]);
+        scored += s.scored;
+        visited += s.visited;
+    };
+    {
+        std::vector<std::jthread> pool;
+        for (size_t t = 1; t < thread_count; ++t)
+            pool.emplace_back(worker);
+        worker();
+    }
+
+    result.probe = m_best;
+    result.bits = Score(m_best, &result.groups, hist, touched);
+    result.scored = scored;
+    result.visited = visited;
+    return result;
+}
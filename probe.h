@@ -0,0 +1,97 @@
+/**
+ * @file    probe.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares ProbeSearch; finds the most informative letter string
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef probe__header_included
+#define probe__header_included
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <span>
+
+#include "dictionary.h"
+
+/**
+ * @brief Searches every letter string (all 26^N of them), not just words,
+ *  for the guess whose clue tells the most about a set of candidates
+ *
+ * The best probe is an upper bound on what any one guess can reveal.
+ * Strings are searched depth first, letter by letter, and a prefix is
+ * pruned when no completion can beat the best string found so far:
+ *  - A clue is determined by which positions match and by how often each
+ *    guessed letter occurs in the secret, so its entropy is at most the
+ *    entropy of that "signature" for the prefix plus a bound for the rest:
+ *    the most any one letter can say at each remaining position plus the
+ *    most that letter counts can say, summed.
+ *  - Letters that no candidate contains always come back missing, so they
+ *    are interchangeable and only the first is tried.
+ * The search starts from the best word so far, so it only explores
+ * strings that might beat it; two-letter prefixes are shared out among
+ * threads. Ties go to the first string in alphabetical order.
+ */
+class ProbeSearch {
+public:
+
+    struct Result {
+        std::string     probe;          ///< Most informative string
+        double          bits{0};        ///< Entropy of its clues
+        size_t          groups{0};      ///< Distinct clues it gives
+        std::string     word;           ///< Most informative word
+        double          word_bits{0};
+        size_t          word_groups{0};
+        uint64_t        scored{0};      ///< Strings whose clues were computed
+        uint64_t        visited{0};     ///< Prefixes (and strings) considered
+    };
+
+    // -- Construction
+
+    /// Search for probes against candidates (indexes into dict)
+    ProbeSearch(const Dictionary& dict, std::span<const uint32_t> candidates);
+
+    // -- Methods
+
+    /// Search every string; threads 0 for one per core
+    Result Run(size_t threads = 0);
+
+    /// Returns the number of strings there are to search
+    uint64_t GetStringCount() const noexcept;
+
+private:
+
+    /// Per thread search state
+    struct Search;
+
+    /// Entropy and number of groups of the clues for probe
+    double Score(std::string_view probe, size_t* groups, std::vector<uint32_t>& hist,
+        std::vector<Pattern>& touched) const;
+    /// Search the strings starting with prefix
+    void SearchPrefix(Search& s, const std::string& prefix);
+    /// Search below depth d of s (a prefix of length d)
+    void SearchFrom(Search& s, size_t d);
+    /// Split level d's groups by letter at position d into level d + 1;
+    /// returns the entropy of level d + 1
+    double Refine(Search& s, size_t d, char letter) const;
+    /// Offer a string as the best found; ties go to the alphabetically first
+    void Offer(double bits, const std::string& probe);
+
+    const Dictionary&           m_dict;
+    std::vector<std::string>    m_words;        ///< Candidate words
+    size_t                      m_word_size{0};
+    std::vector<uint8_t>        m_counts;       ///< Letter counts; candidate * 26 + letter
+    std::vector<double>         m_rest_bound;   ///< Bound on bits from positions d..
+    std::string                 m_letters;      ///< Letters worth trying, in order
+    double                      m_max_bits{0};  ///< log2(candidates)
+
+    std::atomic<double>         m_best_bits{-1};
+    std::mutex                  m_best_lock;    ///< Guards m_best
+    std::string                 m_best;
+};
+
+#endif // ifndef probe__header_included
@@ -0,0 +1,106 @@
+/**
+ * @file    random_stream.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares RandomStream; reproducible, independent random streams
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef random_stream__header_included
+#define random_stream__header_included
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <array>
+
+/**
+ * @brief A counter-based random number generator (Philox4x32-10)
+ *
+ * Each output block is a pure function of (seed, stream, counter), so a
+ * stream needs no state beyond its counter and any number of streams can
+ * be drawn from in parallel without synchronization. Give each game (not
+ * each thread) its own stream and results are the same regardless of how
+ * the games are spread across threads.
+ *
+ * Satisfies UniformRandomBitGenerator, but prefer Below() to the standard
+ * distributions, whose output differs between standard libraries.
+ */
+class RandomStream {
+public:
+
+    using result_type = uint32_t;
+
+    // -- Construction
+
+    RandomStream(uint64_t seed, uint64_t stream) noexcept
+        : m_seed(seed), m_stream(stream) {}
+
+    // -- Methods
+
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept
+        { return std::numeric_limits<result_type>::max(); }
+
+    /// Returns the next 32 random bits
+    result_type operator()() noexcept
+    {
+        if (m_used == m_block.size()) {
+            m_block = Block(m_seed, m_stream, m_counter++);
+            m_used = 0;
+        }
+        return m_block[m_used++];
+    }
+
+    /// Returns a uniformly distributed value in [0, n); n must be non-zero
+    uint32_t Below(uint32_t n) noexcept
+    {
+        // Lemire's multiply and shift, rejecting the few biased values
+        uint64_t m = uint64_t((*this)()) * n;
+        if (static_cast<uint32_t>(m) < n) {
+            const uint32_t threshold = static_cast<uint32_t>(-n) % n;
+            while (static_cast<uint32_t>(m) < threshold)
+                m = uint64_t((*this)()) * n;
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+    /// Returns a uniformly distributed value in [0, 1)
+    double Uniform() noexcept
+    {
+        const uint64_t hi = (*this)() >> 5, lo = (*this)() >> 6;
+        return static_cast<double>((hi << 26) | lo) * 0x1.0p-53;
+    }
+
+    /// Returns block number counter of a stream under a seed
+    static std::array<uint32_t, 4> Block(uint64_t seed, uint64_t stream,
+        uint64_t counter) noexcept
+    {
+        std::array<uint32_t, 4> c = {
+            static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32),
+            static_cast<uint32_t>(stream),  static_cast<uint32_t>(stream >> 32)};
+        std::array<uint32_t, 2> k = {
+            static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+
+        for (int round = 0; round < 10; ++round) {
+            const uint64_t p0 = uint64_t(0xD2511F53) * c[0];
+            const uint64_t p1 = uint64_t(0xCD9E8D57) * c[2];
+            c = {static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k[0], static_cast<uint32_t>(p1),
+                 static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k[1], static_cast<uint32_t>(p0)};
+            k[0] += 0x9E3779B9;
+            k[1] += 0xBB67AE85;
+        }
+
+        return c;
+    }
+
+private:
+
+    uint64_t                    m_seed;
+    uint64_t                    m_stream;
+    uint64_t                    m_counter{0};   ///< Next block to generate
+    std::array<uint32_t, 4>     m_block{};      ///< Current block
+    size_t                      m_used{4};      ///< Values of m_block used
+};
+
+#endif // ifndef random_stream__header_included
@@ -0,0 +1,77 @@
+/**
+ * @file    simulate.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements the strategy registry
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <utility>
+#include <cstring>
+
+#include "simulate.h"
+
+/// Set strategy to the alternative named name, if there is one
+template <size_t... I>
+static bool ParseStrategy(std::string_view name, AnyStrategy& strategy, std::index_sequence<I...>)
+{
+    return ((std::variant_alternative_t<I, AnyStrategy>::name == name ?
+        (strategy.emplace<I>(), true) : false) || ...);
+}
+
+/// Returns the name of a strategy
+std::string_view GetStrategyName(const AnyStrategy& strategy) noexcept
+{
+    return std::visit([](const auto& s) { return std::string_view(s.name); }, strategy);
+}
+
+/// Returns a hash of what, besides the words and the feedback model, a
+/// strategy's choices depend on
+uint64_t GetStrategyHash(const AnyStrategy& strategy) noexcept
+{
+    return std::visit([](const auto& s) -> uint64_t {
+        uint64_t h = 0;
+        if constexpr (requires { s.GetWeights(); }) {
+            for (double w : s.GetWeights()) {
+                uint64_t bits;
+                std::memcpy(&bits, &w, sizeof(bits));
+                h = (h ^ bits) * 0xBF58476D1CE4E5B9ull;
+                h ^= h >> 31;
+            }
+        }
+        return h;
+    }, strategy);
+}
+
+/// Returns true if a strategy's first guess is always the same
+bool HasFixedOpener(const AnyStrategy& strategy) noexcept
+{
+    return std::visit([](const auto& s) { return bool(s.fixed_opener); }, strategy);
+}
+
+/// Look up a strategy by name; returns false if there's no such strategy
+bool ParseStrategy(std::string_view name, AnyStrategy& strategy)
+{
+    return ParseStrategy(name, strategy, std::make_index_sequence<std::variant_size_v<AnyStrategy>>());
+}
+
+/// Returns every strategy
+std::vector<AnyStrategy> GetAllStrategies()
+{
+    return []<size_t... I>(std::index_sequence<I...>) {
+        return std::vector<AnyStrategy>{AnyStrategy(std::in_place_index<I>)...};
+    }(std::make_index_sequence<std::variant_size_v<AnyStrategy>>());
+}
+
+/// Choose the next guess with any strategy
+uint32_t ChooseGuess(AnyStrategy& strategy, const GameState& state, RandomStream& rng)
+{
+    return std::visit([&](auto& s) { return ChooseGuess(s, state, rng); }, strategy);
+}
+
+/// Play one game with any strategy
+GameResult PlayGame(AnyStrategy& strategy, const Dictionary& dict, PatternStore& store,
+    uint32_t secret, uint32_t opener, RandomStream& rng)
+{
+    return std::visit([&](auto& s) { return PlayGame(s, dict, store, secret, opener, rng); }, strategy);
+}
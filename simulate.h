@@ -0,0 +1,98 @@
+/**
+ * @file    simulate.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares simulated games and the strategy registry
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef simulate__header_included
+#define simulate__header_included
+
+#include <string_view>
+#include <cstdint>
+#include <variant>
+#include <vector>
+
+#include "heuristic.h"
+#include "strategy.h"
+
+/// Guesses allowed per game; same as mrdle::TerminalPlay
+constexpr uint32_t game_max_guesses = 6;
+
+/// Outcome of a simulated game
+struct GameResult {
+    uint32_t    secret{0};      ///< Index of the secret word
+    uint32_t    guesses{0};     ///< Guesses made, including the winning one
+    bool        won{false};     ///< Solved within game_max_guesses
+};
+
+/// Choose the next guess (index into the dictionary)
+template <GuessStrategy S>
+uint32_t ChooseGuess(S& strategy, const GameState& state, RandomStream& rng)
+{
+    // With one or two candidates left, guessing one of them is best
+    if (state.candidates.size() <= 2)
+        return state.candidates[0];
+    return strategy.Choose(state, rng);
+}
+
+/**
+ * @brief Play one game against a secret
+ *
+ * @param opener    First guess to use, or PackedWords::no_word to have the
+ *  strategy choose it; see GuessStrategy::fixed_opener
+ */
+template <GuessStrategy S>
+GameResult PlayGame(S& strategy, const Dictionary& dict, PatternStore& store,
+    uint32_t secret, uint32_t opener, RandomStream& rng)
+{
+    GameResult result{secret};
+
+    std::vector<uint32_t> candidates(dict.GetWordCount());
+    for (uint32_t w = 0; w < candidates.size(); ++w)
+        candidates[w] = w;
+
+    for (uint32_t turn = 0; turn < game_max_guesses; ++turn) {
+        const uint32_t guess = ((0 == turn) && (opener != PackedWords::no_word)) ?
+            opener : ChooseGuess(strategy, GameState{dict, store, candidates, turn}, rng);
+        ++result.guesses;
+        if (guess == secret) {
+            result.won = true;
+            break;
+        }
+
+        // Keep the candidates that would have given the same clue
+        const auto row = store.GetRow(guess);
+        const Pattern clue = (*row)[secret];
+        std::erase_if(candidates, [&row, clue](uint32_t c) { return (*row)[c] != clue; });
+    }
+
+    return result;
+}
+
+/// Any of the strategies; this is the registry. Selecting by name yields an
+/// alternative, and visiting it once per game runs a PlayGame instantiated
+/// for that strategy.
+using AnyStrategy = std::variant<EntropyStrategy, CandidateEntropyStrategy, MinimaxStrategy,
+    HeuristicStrategy, FrequencyStrategy, RandomStrategy>;
+
+/// Returns the name of a strategy
+std::string_view GetStrategyName(const AnyStrategy& strategy) noexcept;
+/// Returns a hash of what, besides the words and the feedback model, a
+/// strategy's choices depend on (e.g., its weights); 0 if nothing
+uint64_t GetStrategyHash(const AnyStrategy& strategy) noexcept;
+/// Returns true if a strategy's first guess is always the same
+bool HasFixedOpener(const AnyStrategy& strategy) noexcept;
+/// Look up a strategy by name; returns false if there's no such strategy
+bool ParseStrategy(std::string_view name, AnyStrategy& strategy);
+/// Returns every strategy
+std::vector<AnyStrategy> GetAllStrategies();
+
+/// Choose the next guess with any strategy
+uint32_t ChooseGuess(AnyStrategy& strategy, const GameState& state, RandomStream& rng);
+/// Play one game with any strategy
+GameResult PlayGame(AnyStrategy& strategy, const Dictionary& dict, PatternStore& store,
+    uint32_t secret, uint32_t opener, RandomStream& rng);
+
+#endif // ifndef simulate__header_included
@@ -0,0 +1,408 @@
+/**
+ * @file    strategy.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares the GuessStrategy concept and the solver strategies
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef strategy__header_included
+#define strategy__header_included
+
+#include <string_view>
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <vector>
+#include <array>
+#include <cmath>
+#include <span>
+
+#include "pattern_store.h"
+#include "random_stream.h"
+#include "word_columns.h"
+#include "dictionary.h"
+
+/// What a strategy knows when choosing a guess
+struct GameState {
+    const Dictionary&           dict;
+    PatternStore&               store;      ///< Patterns for dict
+    std::span<const uint32_t>   candidates; ///< Words that satisfy every clue so far
+    uint32_t                    turn;       ///< 0 for the first guess
+};
+
+/**
+ * @brief A way of choosing the next guess
+ *
+ * Simulations are templates instantiated for each strategy, so Choose()
+ * and everything it calls per guess evaluated is inlined; nothing is
+ * looked up at run time except the strategy, by name. A strategy object
+ * may keep scratch space between calls, so each thread needs its own.
+ *
+ * - name: what --strategies calls it
+ * - fixed_opener: the first guess is always the same, so a simulation
+ *   need only choose it once
+ * - Choose(state, rng): index of the next guess; only called with three
+ *   or more candidates
+ */
+template <typename S>
+concept GuessStrategy = requires(S& s, const GameState& state, RandomStream& rng) {
+    { S::name } -> std::convertible_to<std::string_view>;
+    { S::fixed_opener } -> std::convertible_to<bool>;
+    { s.Choose(state, rng) } -> std::same_as<uint32_t>;
+};
+
+/// Indices 0..count-1 without materializing them
+struct IndexRange {
+    struct Iter {
+        uint32_t i;
+        uint32_t operator*() const noexcept { return i; }
+        Iter& operator++() noexcept { ++i; return *this; }
+        bool operator!=(const Iter& o) const noexcept { return i != o.i; }
+    };
+    uint32_t count;
+    Iter begin() const noexcept { return {0}; }
+    Iter end() const noexcept { return {count}; }
+};
+
+/**
+ * @brief Scratch space for strategies that score guesses by how they split
+ *  the candidates into groups with the same pattern
+ */
+class PartitionScorer {
+public:
+
+    /// Size the scratch space for a game's dictionary
+    void Prepare(const GameState& state)
+    {
+        m_hist.resize(state.store.GetPatternCount());
+        m_is_candidate.resize(state.dict.GetWordCount());
+    }
+
+    /// Call fn(group size) for each group that row splits candidates into;
+    /// call Prepare first
+    template <typename Fn>
+    void ForEachGroup(const PatternStore::Row& row, std::span<const uint32_t> candidates, Fn&& fn)
+    {
+        for (auto c : candidates) {
+            if (0 == m_hist[row[c]]++)
+                m_touched.push_back(row[c]);
+        }
+        for (auto p : m_touched) {
+            fn(m_hist[p]);
+            m_hist[p] = 0;
+        }
+        m_touched.clear();
+    }
+
+    /**
+     * @brief Highest scoring of guesses; ties go to candidates, then to the
+     *  first in word list order
+     *
+     * @param score     Called as score(guess index); higher is better
+     */
+    template <typename Guesses, typename Score>
+    uint32_t ChooseBest(const GameState& state, const Guesses& guesses, Score&& score)
+    {
+        Prepare(state);
+        for (auto c : state.candidates)
+            m_is_candidate[c] = 1;
+
+        uint32_t best = state.candidates[0];
+        double best_score = -HUGE_VAL;
+        for (uint32_t g : guesses) {
+            const double s = score(g);
+            if ((s > best_score) || ((s == best_score) && m_is_candidate[g] && !m_is_candidate[best])) {
+                best = g;
+                best_score = s;
+            }
+        }
+
+        for (auto c : state.candidates)
+            m_is_candidate[c] = 0;
+        return best;
+    }
+
+    /// Entropy (bits) of the split of candidates by their patterns in row
+    double GetEntropy(const PatternStore::Row& row, std::span<const uint32_t> candidates)
+    {
+        const double total = static_cast<double>(candidates.size());
+        double bits = 0;
+        ForEachGroup(row, candidates, [&](uint32_t count) {
+            const double f = count / total;
+            bits -= f * std::log2(f);
+        });
+        return bits;
+    }
+
+    /// Size of the largest group in the split of candidates by row
+    uint32_t GetLargestGroup(const PatternStore::Row& row, std::span<const uint32_t> candidates)
+    {
+        uint32_t largest = 0;
+        ForEachGroup(row, candidates, [&](uint32_t count) { largest = std::max(largest, count); });
+        return largest;
+    }
+
+private:
+
+    std::vector<uint32_t>   m_hist;         ///< Candidates by pattern
+    std::vector<Pattern>    m_touched;      ///< Patterns with a count
+    std::vector<uint8_t>    m_is_candidate; ///< By word; all 0 between calls
+};
+
+/**
+ * @brief How every word as a guess splits the candidates, kept from one
+ *  turn to the next
+ *
+ * The entropy of a split of N candidates into groups of c is
+ * log2(N) - sum(c * log2(c)) / N, so for a given N guesses rank by the sum
+ * alone. Each guess keeps its group sizes and its sum; removing a candidate
+ * takes one from its group and adjusts the sum by the change in that one
+ * term. When the new candidates are some of the old, a turn costs one
+ * update per guess per candidate removed, rather than one per candidate
+ * left. A good guess usually leaves fewer than it removes, so when it does
+ * the groups are counted again from the candidates instead.
+ *
+ * Terms are fixed point, so sums are exact whatever order they're built
+ * in and guesses that split the candidates alike tie exactly. Group sizes
+ * are only kept for models with at most max_kept_patterns clues: Wordle's
+ * clues split the candidates so finely that a turn nearly always removes
+ * more than it leaves, and the counts would be memory (per strategy, per
+ * thread) for nothing. They must also fit in max_kept_bytes. Otherwise
+ * every turn is counted from the candidates.
+ */
+class IncrementalEntropy {
+public:
+
+    static constexpr size_t max_kept_patterns = 16;
+    static constexpr size_t max_kept_bytes = size_t(1) << 20;
+
+    /// Bring every guess's split up to the candidates in state
+    void Update(const GameState& state)
+    {
+        const size_t word_count = state.dict.GetWordCount();
+        const size_t pattern_count = state.store.GetPatternCount();
+        if ((&state.store != m_store) || (word_count != m_sums.size()) || (pattern_count != m_pattern_count))
+            Reset(state.store, word_count, pattern_count);
+
+        const bool kept = !m_counts.empty();
+        if (kept && m_valid && FindRemoved(state.candidates) && (m_removed.size() < state.candidates.size())) {
+            for (uint32_t g = 0; g < word_count; ++g) {
+                const auto row_ptr = state.store.GetRow(g);
+                const Pattern* row = row_ptr->data();
+                uint32_t* counts = m_counts.data() + size_t(g) * m_pattern_count;
+                int64_t sum = m_sums[g];
+                for (auto w : m_removed) {
+                    const uint32_t c = counts[row[w]]--;
+                    sum -= m_terms[c] - m_terms[c - 1];
+                }
+                m_sums[g] = sum;
+            }
+        }
+        else if (kept) {
+            // Clear the old counts one by one if that's less than all of them
+            const bool clear_old = m_valid && (m_candidates.size() < m_pattern_count);
+            for (uint32_t g = 0; g < word_count; ++g) {
+                const auto row_ptr = state.store.GetRow(g);
+                const Pattern* row = row_ptr->data();
+                uint32_t* counts = m_counts.data() + size_t(g) * m_pattern_count;
+                if (clear_old) {
+                    for (auto w : m_candidates)
+                        counts[row[w]] = 0;
+                }
+                else
+                    std::fill_n(counts, m_pattern_count, 0);
+                int64_t sum = 0;
+                for (auto w : state.candidates) {
+                    const uint32_t c = counts[row[w]]++;
+                    sum += m_terms[c + 1] - m_terms[c];
+                }
+                m_sums[g] = sum;
+            }
+        }
+        else {
+            m_scorer.Prepare(state);
+            for (uint32_t g = 0; g < word_count; ++g) {
+                int64_t sum = 0;
+                m_scorer.ForEachGroup(*state.store.GetRow(g), state.candidates,
+                    [&](uint32_t c) { sum += m_terms[c]; });
+                m_sums[g] = sum;
+            }
+        }
+
+        m_candidates.assign(state.candidates.begin(), state.candidates.end());
+        m_valid = kept;
+    }
+
+    /// Returns the score of guess g for the candidates of the last Update;
+    /// higher is more informative
+    double GetScore(uint32_t g) const noexcept { return -static_cast<double>(m_sums[g]); }
+
+private:
+
+    /// Fixed point scale of a term
+    static constexpr double term_scale = double(1 << 24);
+
+    /// Size everything for a store; nothing is kept from before
+    void Reset(const PatternStore& store, size_t word_count, size_t pattern_count)
+    {
+        m_store = &store;
+        m_pattern_count = pattern_count;
+        m_sums.assign(word_count, 0);
+        m_terms.resize(word_count + 1);
+        for (size_t c = 0; c <= word_count; ++c)
+            m_terms[c] = c ? std::llround(c * std::log2(double(c)) * term_scale) : 0;
+        m_counts.clear();
+        m_counts.shrink_to_fit();
+        if ((pattern_count <= max_kept_patterns) &&
+            (word_count * pattern_count * sizeof(uint32_t) <= max_kept_bytes))
+        {
+            m_counts.assign(word_count * pattern_count, 0);
+        }
+        m_candidates.clear();
+        m_valid = false;
+    }
+
+    /// Set m_removed to the old candidates that aren't in candidates;
+    /// returns false unless candidates are some of the old, in order
+    bool FindRemoved(std::span<const uint32_t> candidates)
+    {
+        m_removed.clear();
+        size_t i = 0;
+        for (auto c : candidates) {
+            while ((i < m_candidates.size()) && (m_candidates[i] != c))
+                m_removed.push_back(m_candidates[i++]);
+            if (i++ == m_candidates.size())
+                return false;
+        }
+        m_removed.insert(m_removed.end(), m_candidates.begin() + i, m_candidates.end());
+        return true;
+    }
+
+    const PatternStore*     m_store{nullptr};   ///< What the counts are for
+    size_t                  m_pattern_count{0};
+    std::vector<uint32_t>   m_counts;       ///< Group sizes: [guess * m_pattern_count + pattern]
+    std::vector<int64_t>    m_sums;         ///< Sum of terms by guess
+    std::vector<int64_t>    m_terms;        ///< c * log2(c), fixed point, by c
+    std::vector<uint32_t>   m_candidates;   ///< What m_counts counts
+    std::vector<uint32_t>   m_removed;      ///< Scratch for FindRemoved
+    bool                    m_valid{false}; ///< m_counts counts m_candidates
+    PartitionScorer         m_scorer;       ///< When counts aren't kept
+};
+
+/// Most informative guess from the whole word list
+class EntropyStrategy {
+public:
+    static constexpr std::string_view name = "entropy";
+    static constexpr bool fixed_opener = true;
+
+    uint32_t Choose(const GameState& state, RandomStream&)
+    {
+        m_split.Update(state);
+        return m_scorer.ChooseBest(state, IndexRange{static_cast<uint32_t>(state.dict.GetWordCount())},
+            [&](uint32_t g) { return m_split.GetScore(g); });
+    }
+
+private:
+    PartitionScorer     m_scorer;
+    IncrementalEntropy  m_split;    ///< Carried from turn to turn
+};
+
+/// Most informative guess that could be the answer
+class CandidateEntropyStrategy {
+public:
+    static constexpr std::string_view name = "candidate-entropy";
+    static constexpr bool fixed_opener = true;
+
+    uint32_t Choose(const GameState& state, RandomStream&)
+    {
+        return m_scorer.ChooseBest(state, state.candidates,
+            [&](uint32_t g) { return m_scorer.GetEntropy(*state.store.GetRow(g), state.candidates); });
+    }
+
+private:
+    PartitionScorer m_scorer;
+};
+
+/// Guess from the whole word list that leaves the fewest candidates in the
+/// worst case
+class MinimaxStrategy {
+public:
+    static constexpr std::string_view name = "minimax";
+    static constexpr bool fixed_opener = true;
+
+    uint32_t Choose(const GameState& state, RandomStream&)
+    {
+        return m_scorer.ChooseBest(state, IndexRange{static_cast<uint32_t>(state.dict.GetWordCount())},
+            [&](uint32_t g) {
+                return -static_cast<double>(m_scorer.GetLargestGroup(*state.store.GetRow(g), state.candidates));
+            });
+    }
+
+private:
+    PartitionScorer m_scorer;
+};
+
+/// Candidate whose letters are most common among the candidates, counting
+/// each position and each distinct letter
+class FrequencyStrategy {
+public:
+    static constexpr std::string_view name = "frequency";
+    static constexpr bool fixed_opener = true;
+
+    uint32_t Choose(const GameState& state, RandomStream&)
+    {
+        const auto& words = state.dict.GetWords();
+        const size_t ws = words.GetWordSize();
+
+        m_at.assign(ws * 26, 0);
+        std::array<uint32_t, 26> present{};
+        for (auto c : state.candidates) {
+            const auto word = words[c];
+            for (size_t p = 0; p < ws; ++p) {
+                if (WordColumns::LetterBit(word[p]))
+                    ++m_at[p * 26 + (word[p] - 'a')];
+            }
+            const auto mask = WordColumns::MakeMask(word);
+            for (int l = 0; l < 26; ++l)
+                present[l] += (mask >> l) & 1;
+        }
+
+        uint32_t best = state.candidates[0];
+        uint64_t best_score = 0;
+        for (auto c : state.candidates) {
+            const auto word = words[c];
+            uint64_t score = 0;
+            for (size_t p = 0; p < ws; ++p) {
+                if (WordColumns::LetterBit(word[p]))
+                    score += m_at[p * 26 + (word[p] - 'a')];
+            }
+            const auto mask = WordColumns::MakeMask(word);
+            for (int l = 0; l < 26; ++l)
+                score += ((mask >> l) & 1) * present[l];
+            if (score > best_score) {
+                best = c;
+                best_score = score;
+            }
+        }
+
+        return best;
+    }
+
+private:
+    std::vector<uint32_t>   m_at;   ///< Candidates with letter at position
+};
+
+/// Any candidate
+class RandomStrategy {
+public:
+    static constexpr std::string_view name = "random";
+    static constexpr bool fixed_opener = false;
+
+    uint32_t Choose(const GameState& state, RandomStream& rng)
+    {
+        return state.candidates[rng.Below(static_cast<uint32_t>(state.candidates.size()))];
+    }
+};
+
+#endif // ifndef strategy__header_included
@@ -0,0 +1,256 @@
+/**
+ * @file    tournament.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements Tournament; plays strategies against the same secrets
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <fmt/format.h>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+
+#include "tournament.h"
+
+/// Random streams for games are numbered from here so that they never
+/// collide with the streams that pick secrets (numbered by game)
+static constexpr uint64_t strategy_stream_base = uint64_t(1) << 62;
+
+/// Returns the CPU time used by the calling thread, in seconds
+static double GetThreadCpuSeconds()
+{
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+    // Process time; only meaningful with one thread
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+Tournament::Tournament(std::shared_ptr<PatternStore> store, Options options)
+    : m_store(std::move(store)), m_options(std::move(options))
+{
+}
+
+/// Returns a strategy's fixed opener, from the artifact cache if it's there
+uint32_t Tournament::ChooseOpener(AnyStrategy& strategy) const
+{
+    const auto& dict = *m_store->GetDictionary();
+    auto choose = [&]() {
+        std::vector<uint32_t> everything(dict.GetWordCount());
+        for (uint32_t w = 0; w < everything.size(); ++w)
+            everything[w] = w;
+        RandomStream rng(m_options.seed, strategy_stream_base - 1);
+        return ChooseGuess(strategy, GameState{dict, *m_store, everything, 0}, rng);
+    };
+    if (!m_options.artifacts)
+        return choose();
+
+    const auto name = fmt::format("opener-{}-{}", GetStrategyName(strategy),
+        GetFeedbackName(m_store->GetFeedback()));
+    const uint64_t hash = dict.GetContentHash() ^ (GetStrategyHash(strategy) * 0x9E3779B97F4A7C15ull);
+    MappedFile mapping;
+    uint64_t opener = PackedWords::no_word;
+    if (m_options.artifacts->LookupOrBuild(name, opener_version, hash,
+            [&](ImageWriter& out) { out.WriteValue(choose()); }, mapping))
+    {
+        ImageReader in(mapping.GetData());
+        if (in.ReadValue(opener) && (opener < dict.GetWordCount()))
+            return static_cast<uint32_t>(opener);
+    }
+
+    return choose();
+}
+
+/// Returns the secret for game i
+uint32_t Tournament::GetSecret(size_t game) const noexcept
+{
+    // Every word once, or random words picked the same way as
+    // mrdle::GetRandomWord so a game can be replayed by hand
+    const auto word_count = static_cast<uint32_t>(m_store->GetDictionary()->GetWordCount());
+    if (0 == m_options.games)
+        return static_cast<uint32_t>(game);
+    return RandomStream(m_options.seed, game).Below(word_count);
+}
+
+/// Play every game with every strategy
+void Tournament::Run()
+{
+    const auto& dict = *m_store->GetDictionary();
+    const size_t strategy_count = m_options.strategies.size();
+    m_game_count = m_options.games ? m_options.games : dict.GetWordCount();
+
+    m_entries.clear();
+    for (auto s : m_options.strategies)
+        m_entries.push_back(Entry{s, PackedWords::no_word, std::vector<GameResult>(m_game_count)});
+
+    // A fixed opener is the same for every game, so choose it once
+    for (auto& e : m_entries) {
+        if (!HasFixedOpener(e.strategy) || !dict.GetWordCount())
+            continue;
+        const double t0 = GetThreadCpuSeconds();
+        e.opener = ChooseOpener(e.strategy);
+        e.cpu_seconds += GetThreadCpuSeconds() - t0;
+    }
+
+    // Games are handed out one at a time, alternating strategies, and each
+    // result goes to its own slot; the order they finish in doesn't matter
+    const size_t item_count = strategy_count * m_game_count;
+    m_thread_count = m_options.threads ? m_options.threads :
+        std::max<size_t>(1, std::thread::hardware_concurrency());
+    m_thread_count = std::max<size_t>(1, std::min(m_thread_count, item_count));
+
+    // Strategies keep scratch space, so each thread plays its own copies;
+    // choosing the PlayGame for a strategy is the only run time dispatch
+    std::atomic<size_t> next_item{0};
+    std::vector<std::vector<double>> cpu(m_thread_count, std::vector<double>(strategy_count, 0));
+    auto worker = [&](size_t t) {
+        std::vector<AnyStrategy> strategies;
+        for (const auto& e : m_entries)
+            strategies.push_back(e.strategy);
+
+        for (size_t item; (item = next_item++) < item_count; ) {
+            const size_t s = item % strategy_count;
+            const size_t game = item / strategy_count;
+            auto& e = m_entries[s];
+
+            const double t0 = GetThreadCpuSeconds();
+            RandomStream rng(m_options.seed, strategy_stream_base + game);
+            e.results[game] = PlayGame(strategies[s], dict, *m_store, GetSecret(game), e.opener, rng);
+            cpu[t][s] += GetThreadCpuSeconds() - t0;
+        }
+    };
+
+    const auto t_start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> threads;
+        for (size_t t = 1; t < m_thread_count; ++t)
+            threads.emplace_back(worker, t);
+        worker(0);
+    }
+    m_wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+
+    for (const auto& per_thread : cpu) {
+        for (size_t s = 0; s < strategy_count; ++s)
+            m_entries[s].cpu_seconds += per_thread[s];
+    }
+}
+
+/// Returns the mean guesses per game of strategy i
+double Tournament::GetMeanScore(size_t i) const
+{
+    const auto& results = m_entries.at(i).results;
+    double score = 0;
+    for (const auto& r : results)
+        score += GetScore(r);
+    return results.empty() ? 0 : score / results.size();
+}
+
+/// Returns the report: summary, significance and per-secret results
+std::string Tournament::GetReport() const
+{
+    const auto& dict = *m_store->GetDictionary();
+    std::string report = fmt::format("Tournament: {} games per strategy, seed {}, {} threads, {:.2f} s\n",
+        m_game_count, m_options.seed, m_thread_count, m_wall_seconds);
+    if (m_entries.empty() || !m_game_count)
+        return report;
+
+    // Summary
+    report += fmt::format("\n{:<18} {:<10} {:>7} {:>7} {:>5} ", "strategy", "opener",
+        "solved", "failed", "avg");
+    for (uint32_t g = 1; g <= game_max_guesses; ++g)
+        report += fmt::format(" {:>5}", g);
+    report += fmt::format(" {:>8}\n", "cpu s");
+
+    std::vector<double> mean_score;
+    for (const auto& e : m_entries) {
+        std::vector<size_t> hist(game_max_guesses + 1, 0);
+        size_t won = 0, guesses = 0;
+        double score = 0;
+        for (const auto& r : e.results) {
+            if (r.won) {
+                ++won;
+                guesses += r.guesses;
+                ++hist[r.guesses];
+            }
+            score += GetScore(r);
+        }
+        mean_score.push_back(score / m_game_count);
+
+        const auto opener = (e.opener != PackedWords::no_word) ?
+            std::string(dict.GetWord(e.opener)) : std::string("-");
+        report += fmt::format("{:<18} {:<10} {:>7} {:>6.2f}% {:>5.3f} ", GetStrategyName(e.strategy),
+            opener, won, 100.0 * (m_game_count - won) / m_game_count,
+            won ? double(guesses) / won : 0.0);
+        for (uint32_t g = 1; g <= game_max_guesses; ++g)
+            report += fmt::format(" {:>5}", hist[g]);
+        report += fmt::format(" {:>8.2f}\n", e.cpu_seconds);
+    }
+
+    // Significance: a paired t-test of each strategy against the best on
+    // the same secrets. With this many games the t statistic is close
+    // enough to normal for the p-value.
+    const size_t best = std::min_element(mean_score.begin(), mean_score.end()) - mean_score.begin();
+    if (m_entries.size() > 1) {
+        report += fmt::format("\nCompared with {} (paired by secret; a loss counts as {} guesses):\n",
+            GetStrategyName(m_entries[best].strategy), game_max_guesses + 1);
+        for (size_t s = 0; s < m_entries.size(); ++s) {
+            if (s == best)
+                continue;
+
+            double sum = 0, sum_sq = 0;
+            for (size_t g = 0; g < m_game_count; ++g) {
+                const double d = GetScore(m_entries[s].results[g]) - GetScore(m_entries[best].results[g]);
+                sum += d;
+                sum_sq += d * d;
+            }
+            const double n = static_cast<double>(m_game_count);
+            const double mean = sum / n;
+            const double var = (n > 1) ? (sum_sq - sum * mean) / (n - 1) : 0;
+
+            report += fmt::format("  {:<18} {:+.3f} guesses/game", GetStrategyName(m_entries[s].strategy), mean);
+            if (var <= 0) {
+                report += "  (same on every secret)\n";
+                continue;
+            }
+            const double t = mean / std::sqrt(var / n);
+            const double p = std::erfc(std::fabs(t) / std::sqrt(2.0));
+            if (p < 1e-6)
+                report += fmt::format("  t = {:.2f}  p < 1e-6\n", t);
+            else
+                report += fmt::format("  t = {:.2f}  p = {:.4f}\n", t, p);
+        }
+    }
+
+    // Per-secret results, for the secrets that anyone lost; everyone won
+    // every other game
+    std::string lost;
+    for (size_t g = 0; g < m_game_count; ++g) {
+        if (std::all_of(m_entries.begin(), m_entries.end(), [g](const Entry& e) { return e.results[g].won; }))
+            continue;
+
+        lost += fmt::format("  {:<12}", dict.GetWord(GetSecret(g)));
+        for (const auto& e : m_entries) {
+            const auto& r = e.results[g];
+            lost += fmt::format(" {:>18}", r.won ? std::to_string(r.guesses) : std::string("X"));
+        }
+        lost += "\n";
+    }
+
+    if (lost.empty())
+        report += "\nEvery strategy solved every secret\n";
+    else {
+        report += fmt::format("\nSecrets lost by any strategy (guesses, or X if lost):\n  {:<12}", "secret");
+        for (const auto& e : m_entries)
+            report += fmt::format(" {:>18}", GetStrategyName(e.strategy));
+        report += "\n" + lost;
+    }
+
+    return report;
+}
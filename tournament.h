@@ -0,0 +1,86 @@
+/**
+ * @file    tournament.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares Tournament; plays strategies against the same secrets
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef tournament__header_included
+#define tournament__header_included
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <string>
+
+#include "artifact_cache.h"
+#include "pattern_store.h"
+#include "simulate.h"
+
+/**
+ * @brief Plays several strategies against the same secrets and compares them
+ *
+ * Every strategy plays every game, and game i always gets the same secret
+ * and the same random stream, whatever the strategy and however many
+ * threads the games are spread across; results are reproducible for a
+ * given seed. A fixed opener depends only on the words, the feedback model
+ * and the strategy, so with an artifact cache it's chosen once and then
+ * read back on every later run.
+ */
+class Tournament {
+public:
+
+    struct Options {
+        std::vector<AnyStrategy> strategies;
+        size_t                   games{0};      ///< 0 for every word once
+        size_t                   threads{0};    ///< 0 for one per core
+        uint64_t                 seed{0};
+        const ArtifactCache*     artifacts{nullptr};    ///< Keeps fixed openers; may be null
+    };
+
+    // -- Construction
+
+    Tournament(std::shared_ptr<PatternStore> store, Options options);
+
+    // -- Methods
+
+    /// Play every game with every strategy
+    void Run();
+    /// Returns the report: summary, significance and per-secret results
+    std::string GetReport() const;
+    /// Returns the mean guesses per game of strategy i (in Options order),
+    /// counting a loss as one more than the most guesses allowed
+    double GetMeanScore(size_t i) const;
+
+private:
+
+    /// Results of one strategy
+    struct Entry {
+        AnyStrategy             strategy;
+        uint32_t                opener{PackedWords::no_word};
+        std::vector<GameResult> results;        ///< By game
+        double                  cpu_seconds{0}; ///< Summed over threads
+    };
+
+    /// Returns a strategy's fixed opener, from the artifact cache if it's there
+    uint32_t ChooseOpener(AnyStrategy& strategy) const;
+    /// Returns the secret for game i
+    uint32_t GetSecret(size_t game) const noexcept;
+    /// Guesses a game counts for in comparisons; a loss counts as one more
+    /// than the most guesses allowed
+    static double GetScore(const GameResult& r) noexcept
+        { return r.won ? r.guesses : game_max_guesses + 1; }
+
+    /// Bump whenever how an opener artifact is laid out changes
+    static constexpr uint64_t opener_version = 1;
+
+    std::shared_ptr<PatternStore>   m_store;
+    Options                         m_options;
+    size_t                          m_game_count{0};
+    size_t                          m_thread_count{0};
+    double                          m_wall_seconds{0};
+    std::vector<Entry>              m_entries;
+};
+
+#endif // ifndef tournament__header_included
@@ -0,0 +1,102 @@
+/**
+ * @file    traps.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements trap clusters; families of words that differ in one letter
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <unordered_map>
+#include <algorithm>
+
+#include "traps.h"
+
+/// Bits per character in a key
+static constexpr uint32_t key_char_bits = 5;
+
+/// Returns a word's characters packed into an integer; letters are 1..26
+/// and anything else 27, so 0 can stand for the blank position
+static uint64_t MakeKey(std::string_view word) noexcept
+{
+    uint64_t key = 0;
+    for (size_t p = 0; p < word.length(); ++p) {
+        const char ch = word[p];
+        const uint64_t code = ((ch >= 'a') && (ch <= 'z')) ? (ch - 'a' + 1) : 27;
+        key |= code << (p * key_char_bits);
+    }
+    return key;
+}
+
+/// Returns the cluster as a pattern, '?' for the position that differs
+std::string TrapCluster::GetPattern(const PackedWords& list) const
+{
+    std::string pattern(list[words.front()]);
+    pattern[position] = '?';
+    return pattern;
+}
+
+/// Returns the letters the words have at position, in order
+std::string TrapCluster::GetLetters(const PackedWords& list) const
+{
+    std::string letters;
+    for (auto w : words)
+        letters += list[w][position];
+    return letters;
+}
+
+/// Returns the fewest guesses that separate the words
+uint32_t TrapCluster::GetSeparatingGuesses(size_t word_size) const noexcept
+{
+    const size_t unknown = words.size() - 1;
+    return static_cast<uint32_t>((unknown + word_size - 1) / word_size);
+}
+
+/// Find every trap cluster of two or more words
+std::vector<TrapCluster> FindTrapClusters(const PackedWords& list)
+{
+    const size_t ws = list.GetWordSize();
+    if (!ws || (ws > max_trap_word_size))
+        return {};
+
+    std::vector<uint64_t> keys(list.size());
+    for (uint32_t w = 0; w < list.size(); ++w)
+        keys[w] = MakeKey(list[w]);
+
+    // Per position, a key maps to the first word with it until a second
+    // word shows up, and then to the cluster
+    std::vector<TrapCluster> clusters;
+    std::unordered_map<uint64_t, uint32_t> first;
+    first.reserve(list.size());
+    constexpr uint32_t cluster_bit = 0x80000000;
+    for (uint32_t p = 0; p < ws; ++p) {
+        const uint64_t blank = ~(uint64_t((1 << key_char_bits) - 1) << (p * key_char_bits));
+        first.clear();
+        for (uint32_t w = 0; w < list.size(); ++w) {
+            auto [it, added] = first.try_emplace(keys[w] & blank, w);
+            if (added)
+                continue;
+            if (!(it->second & cluster_bit)) {
+                clusters.push_back(TrapCluster{p, {it->second}});
+                it->second = cluster_bit | static_cast<uint32_t>(clusters.size() - 1);
+            }
+            clusters[it->second & ~cluster_bit].words.push_back(w);
+        }
+    }
+
+    // Largest first; bucketed by size to keep it linear
+    size_t largest = 0;
+    for (const auto& c : clusters)
+        largest = std::max(largest, c.words.size());
+    std::vector<std::vector<uint32_t>> by_size(largest + 1);
+    for (uint32_t i = 0; i < clusters.size(); ++i)
+        by_size[clusters[i].words.size()].push_back(i);
+
+    std::vector<TrapCluster> sorted;
+    sorted.reserve(clusters.size());
+    for (size_t size = largest; size >= 2; --size) {
+        for (auto i : by_size[size])
+            sorted.push_back(std::move(clusters[i]));
+    }
+
+    return sorted;
+}
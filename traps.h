@@ -0,0 +1,58 @@
+/**
+ * @file    traps.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares trap clusters; families of words that differ in one letter
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef traps__header_included
+#define traps__header_included
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "packed_words.h"
+
+/// Longest word FindTrapClusters handles; keys pack 5 bits per letter
+constexpr size_t max_trap_word_size = 12;
+
+/**
+ * @brief Words that are the same except at one position (e.g., ?ight)
+ *
+ * Guessing them one at a time rules out one word per guess, which is
+ * how most games are lost.
+ */
+struct TrapCluster {
+    uint32_t                position{0};    ///< Where the words differ
+    std::vector<uint32_t>   words;          ///< Indexes of the words, in order
+
+    /// Returns the cluster as a pattern, '?' for the position that differs
+    std::string GetPattern(const PackedWords& list) const;
+    /// Returns the letters the words have at position, in order
+    std::string GetLetters(const PackedWords& list) const;
+    /**
+     * @brief Returns the fewest guesses that separate the words
+     *
+     * A guess can test at most one letter per position, and once all but
+     * one letter are ruled out the last is known; so this is a lower bound
+     * that a well chosen probe (not necessarily a word) can reach.
+     */
+    uint32_t GetSeparatingGuesses(size_t word_size) const noexcept;
+};
+
+/**
+ * @brief Find every trap cluster of two or more words
+ *
+ * Each word is keyed once per position with that position blanked, so
+ * words that share a key differ only there. Keys are the letters packed
+ * into an integer (exact, so no comparisons are needed), so this is linear
+ * in the number of words times the word size. Clusters come out largest
+ * first; clusters of the same size are in position, then word, order.
+ *
+ * @return No clusters if the words are longer than max_trap_word_size
+ */
+std::vector<TrapCluster> FindTrapClusters(const PackedWords& list);
+
+#endif // ifndef traps__header_included
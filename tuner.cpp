@@ -0,0 +1,75 @@
+/**
+ * @file    tuner.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements WeightTuner; searches heuristic weights by self-play
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+#include "tournament.h"
+#include "tuner.h"
+
+WeightTuner::WeightTuner(std::shared_ptr<PatternStore> store, std::shared_ptr<FeatureCache> cache,
+    Options options)
+    : m_store(std::move(store)), m_cache(std::move(cache)), m_options(options)
+{
+}
+
+/// Returns the mean guesses per game with weights, simulating if needed
+double WeightTuner::Evaluate(const HeuristicWeights& weights)
+{
+    if (auto it = m_scores.find(weights); it != m_scores.end())
+        return it->second;
+
+    Tournament::Options options;
+    options.strategies = {AnyStrategy(HeuristicStrategy(weights, m_cache))};
+    options.games   = m_options.games;
+    options.threads = m_options.threads;
+    options.seed    = m_options.seed;
+    options.artifacts = m_options.artifacts;
+
+    Tournament tournament(m_store, std::move(options));
+    tournament.Run();
+    const double score = tournament.GetMeanScore(0);
+    m_scores.emplace(weights, score);
+    return score;
+}
+
+/// Search from start, printing each new best; returns the best weights
+HeuristicWeights WeightTuner::Run(const HeuristicWeights& start)
+{
+    m_scores.clear();
+    HeuristicWeights best = start;
+    m_best_score = Evaluate(best);
+    fmt::print("{:>4}  {:.4f}  {}\n", m_scores.size(), m_best_score, fmt::join(best, " "));
+
+    double step = m_options.first_step;
+    while ((step >= m_options.last_step) && (m_scores.size() < m_options.max_evaluations)) {
+        bool improved = false;
+        for (size_t i = 0; (i < heuristic_feature_count) && !improved; ++i) {
+            for (double dir : {1.0, -1.0}) {
+                HeuristicWeights w = best;
+                w[i] += dir * step;
+                if ((w[i] < 0) || (m_scores.size() >= m_options.max_evaluations))
+                    continue;
+
+                const double score = Evaluate(w);
+                if (score < m_best_score) {
+                    best = w;
+                    m_best_score = score;
+                    improved = true;
+                    fmt::print("{:>4}  {:.4f}  {}\n", m_scores.size(), m_best_score, fmt::join(best, " "));
+                    break;
+                }
+            }
+        }
+
+        if (!improved)
+            step /= 2;
+    }
+
+    return best;
+}
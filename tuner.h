@@ -0,0 +1,71 @@
+/**
+ * @file    tuner.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares WeightTuner; searches heuristic weights by self-play
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef tuner__header_included
+#define tuner__header_included
+
+#include <cstdint>
+#include <memory>
+#include <map>
+
+#include "artifact_cache.h"
+#include "pattern_store.h"
+#include "heuristic.h"
+
+/**
+ * @brief Searches HeuristicStrategy weights by coordinate descent
+ *
+ * Each weight vector is scored by a full simulation (a Tournament of one)
+ * over the same secrets, so scores are directly comparable. Starting from
+ * the given weights, it tries a step up and down each weight in turn and
+ * keeps the first that improves the mean guesses per game; when no step
+ * helps, the step is halved. Every simulation shares one FeatureCache,
+ * so only states that no earlier weights reached cost more than a dot
+ * product per guess.
+ */
+class WeightTuner {
+public:
+
+    struct Options {
+        size_t      games{0};               ///< 0 for every word once
+        size_t      threads{0};             ///< 0 for one per core
+        uint64_t    seed{0};
+        size_t      max_evaluations{100};   ///< Simulations to run at most
+        double      first_step{0.5};
+        double      last_step{1.0 / 64};    ///< Stop when the step falls below
+        const ArtifactCache*    artifacts{nullptr}; ///< Keeps openers across runs; may be null
+    };
+
+    // -- Construction
+
+    WeightTuner(std::shared_ptr<PatternStore> store, std::shared_ptr<FeatureCache> cache,
+        Options options);
+
+    // -- Methods
+
+    /// Search from start, printing each new best; returns the best weights
+    HeuristicWeights Run(const HeuristicWeights& start);
+
+    /// Returns the score of the best weights (mean guesses per game)
+    double GetBestScore() const noexcept { return m_best_score; }
+    /// Returns the number of simulations run
+    size_t GetEvaluationCount() const noexcept { return m_scores.size(); }
+
+private:
+
+    /// Returns the mean guesses per game with weights, simulating if needed
+    double Evaluate(const HeuristicWeights& weights);
+
+    std::shared_ptr<PatternStore>           m_store;
+    std::shared_ptr<FeatureCache>           m_cache;
+    Options                                 m_options;
+    std::map<HeuristicWeights, double>      m_scores;       ///< By weights tried
+    double                                  m_best_score{0};
+};
+
+#endif // ifndef tuner__header_included
@@ -9,7 +9,11 @@
 #ifndef util__header_included
 #define util__header_included
 
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
 #include <string>
+#include <span>
 
 /// Convert given string to lower case
 static inline std::string& string_to_lower(std::string& s)
@@ -35,4 +39,28 @@ static inline std::string& string_trim (std::string& s,
     return s;
 }
 
+/// 64-bit FNV-1a hash of a string; pass a previous result to chain strings
+static inline uint64_t hash_fnv1a(std::string_view s,
+    uint64_t hash = 0xcbf29ce484222325)
+{
+    for (unsigned char ch : s) {
+        hash ^= ch;
+        hash *= 0x100000001b3;
+    }
+
+    return hash;
+}
+
+/// Hash of a list of word indexes, such as a set of candidates
+static inline uint64_t hash_candidates(std::span<const uint32_t> candidates)
+{
+    uint64_t h = candidates.size() * 0x9E3779B97F4A7C15ull;
+    for (auto c : candidates) {
+        h = (h ^ c) * 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 31;
+    }
+
+    return h;
+}
+
 #endif // ifndef util__header_included
@@ -0,0 +1,196 @@
+/**
+ * @file    word_columns.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements WordColumns; a column-major copy of the word list
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <algorithm>
+#include <array>
+
+#include "word_columns.h"
+
+/// Build the store for a word list into an image
+void WordColumns::Build(const PackedWords& words, ImageWriter& out,
+    bool positional_index)
+{
+    const size_t word_count = words.size();
+    const size_t word_size  = words.GetWordSize();
+
+    std::vector<uint8_t> columns(word_count * word_size);
+    std::vector<LetterMask> masks(word_count);
+
+    for (size_t w = 0; w < word_count; ++w) {
+        for (size_t p = 0; p < word_size; ++p)
+            columns[p * word_count + w] = static_cast<uint8_t>(words[w][p]);
+        masks[w] = MakeMask(words[w]);
+    }
+
+    // Letter statistics
+    std::vector<uint32_t> letter_counts(word_size * 26, 0);
+    std::vector<uint32_t> presence_counts(26, 0);
+    size_t repeat_count = 0;
+    for (size_t w = 0; w < word_count; ++w) {
+        for (size_t p = 0; p < word_size; ++p) {
+            const char ch = words[w][p];
+            if (LetterBit(ch))
+                ++letter_counts[p * 26 + (ch - 'a')];
+        }
+        for (int l = 0; l < 26; ++l)
+            presence_counts[l] += (masks[w] >> l) & 1;
+        if (static_cast<size_t>(std::popcount(masks[w])) < word_size)
+            ++repeat_count;
+    }
+
+    // Positional index: a counting sort of word indices by (pos, letter).
+    // Words are visited in order, so each group ends up ascending. Without
+    // it, both arrays are empty.
+    std::vector<uint32_t> posting_offsets, postings;
+    if (positional_index) {
+        posting_offsets.assign(word_size * 26 + 1, 0);
+        for (size_t g = 0; g < word_size * 26; ++g)
+            posting_offsets[g + 1] = posting_offsets[g] + letter_counts[g];
+        postings.resize(posting_offsets.back());
+        std::vector<uint32_t> fill(posting_offsets.begin(), posting_offsets.end() - 1);
+        for (size_t w = 0; w < word_count; ++w) {
+            for (size_t p = 0; p < word_size; ++p) {
+                const char ch = words[w][p];
+                if (LetterBit(ch))
+                    postings[fill[p * 26 + (ch - 'a')]++] = static_cast<uint32_t>(w);
+            }
+        }
+    }
+
+    out.WriteValue(word_count);
+    out.WriteValue(word_size);
+    out.WriteValue(repeat_count);
+    out.Write(std::span<const uint8_t>(columns));
+    out.Write(std::span<const LetterMask>(masks));
+    out.Write(std::span<const uint32_t>(letter_counts));
+    out.Write(std::span<const uint32_t>(presence_counts));
+    out.Write(std::span<const uint32_t>(postings));
+    out.Write(std::span<const uint32_t>(posting_offsets));
+}
+
+/// Returns the image bytes Build writes for the store
+size_t WordColumns::GetImageBytes(size_t word_count, size_t word_size, bool positional_index)
+{
+    // Three values and seven arrays, each array prefixed with its count
+    size_t bytes = 10 * sizeof(uint64_t) +
+        ImageReader::Pad(word_count * word_size) +
+        ImageReader::Pad(word_count * sizeof(LetterMask)) +
+        ImageReader::Pad(word_size * 26 * sizeof(uint32_t)) +
+        ImageReader::Pad(26 * sizeof(uint32_t));
+    if (positional_index) {
+        bytes += ImageReader::Pad(word_count * word_size * sizeof(uint32_t)) +
+            ImageReader::Pad((word_size * 26 + 1) * sizeof(uint32_t));
+    }
+
+    return bytes;
+}
+
+/// Load a view of a store written by Build
+bool WordColumns::Load(ImageReader& in) noexcept
+{
+    uint64_t word_count, word_size, repeat_count;
+    in.ReadValue(word_count);
+    in.ReadValue(word_size);
+    in.ReadValue(repeat_count);
+    in.Read(m_columns);
+    in.Read(m_masks);
+    in.Read(m_letter_counts);
+    in.Read(m_presence_counts);
+    in.Read(m_postings);
+    in.Read(m_posting_offsets);
+    if (!in.IsOk())
+        return false;
+
+    m_word_count   = static_cast<size_t>(word_count);
+    m_word_size    = static_cast<size_t>(word_size);
+    m_repeat_count = static_cast<size_t>(repeat_count);
+
+    // Sanity check the shape of everything so lookups can't run off the end
+    return (m_columns.size() == m_word_count * m_word_size) &&
+        (m_masks.size() == m_word_count) &&
+        (m_letter_counts.size() == m_word_size * 26) &&
+        (m_presence_counts.size() == 26) &&
+        ((m_posting_offsets.empty() && m_postings.empty()) ||
+         ((m_posting_offsets.size() == m_word_size * 26 + 1) &&
+          std::is_sorted(m_posting_offsets.begin(), m_posting_offsets.end()) &&
+          (m_posting_offsets.back() == m_postings.size())));
+}
+
+/// Returns the (ascending) indices of the words with letter ch at pos
+std::span<const uint32_t> WordColumns::GetPostings(size_t pos, char ch) const noexcept
+{
+    if (!LetterBit(ch) || (pos >= m_word_size) || !HasPostings())
+        return {};
+
+    const size_t g = pos * 26 + (ch - 'a');
+    return m_postings.subspan(m_posting_offsets[g], m_posting_offsets[g + 1] - m_posting_offsets[g]);
+}
+
+// The filters below are branch-free loops over contiguous bytes so that
+// the compiler can compare a full vector register of words at a time.
+
+/// Clear keep[w] for words missing a required letter or having a forbidden one
+void WordColumns::KeepIfMask(LetterMask required, LetterMask forbidden,
+    std::vector<uint8_t>& keep) const
+{
+    const LetterMask* masks = m_masks.data();
+    uint8_t* k = keep.data();
+
+    for (size_t w = 0; w < m_word_count; ++w)
+        k[w] &= static_cast<uint8_t>(((masks[w] & required) == required) & ((masks[w] & forbidden) == 0));
+}
+
+/// Clear keep[w] for words that do not have letter ch at pos
+void WordColumns::KeepIfLetterAt(size_t pos, char ch, std::vector<uint8_t>& keep) const
+{
+    const uint8_t* col = m_columns.data() + pos * m_word_count;
+    const auto c = static_cast<uint8_t>(ch);
+    uint8_t* k = keep.data();
+
+    for (size_t w = 0; w < m_word_count; ++w)
+        k[w] &= static_cast<uint8_t>(col[w] == c);
+}
+
+/// Clear keep[w] for words that have letter ch at pos
+void WordColumns::KeepIfLetterNotAt(size_t pos, char ch, std::vector<uint8_t>& keep) const
+{
+    const uint8_t* col = m_columns.data() + pos * m_word_count;
+    const auto c = static_cast<uint8_t>(ch);
+    uint8_t* k = keep.data();
+
+    for (size_t w = 0; w < m_word_count; ++w)
+        k[w] &= static_cast<uint8_t>(col[w] != c);
+}
+
+/// Clear keep[w] for words whose letter at pos isn't in letters
+void WordColumns::KeepIfLetterIn(size_t pos, LetterMask letters, bool others,
+    std::vector<uint8_t>& keep) const
+{
+    // A table lookup per word rather than a compare per allowed letter
+    std::array<uint8_t, 256> allowed;
+    for (size_t c = 0; c < allowed.size(); ++c) {
+        const auto bit = LetterBit(static_cast<char>(c));
+        allowed[c] = static_cast<uint8_t>(bit ? ((letters & bit) != 0) : others);
+    }
+
+    const uint8_t* col = m_columns.data() + pos * m_word_count;
+    uint8_t* k = keep.data();
+
+    for (size_t w = 0; w < m_word_count; ++w)
+        k[w] &= allowed[col[w]];
+}
+
+/// Returns the letter mask for a word
+WordColumns::LetterMask WordColumns::MakeMask(std::string_view word) noexcept
+{
+    LetterMask mask = 0;
+    for (char ch : word)
+        mask |= LetterBit(ch);
+
+    return mask;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file    word_columns.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares WordColumns; a column-major copy of the word list
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef word_columns__header_included
+#define word_columns__header_included
+
+#include <string_view>
+#include <cstdint>
+#include <vector>
+#include <bit>
+#include <string>
+#include <span>
+
+#include "packed_words.h"
+#include "dict_image.h"
+
+/**
+ * @brief Column-major (struct-of-arrays) store of a word list
+ *
+ * Letter N of every word is kept in one contiguous byte array, so
+ * positional checks ("is X at position N?") are straight byte compares
+ * over a single array that the compiler can vectorize. A parallel array
+ * holds the letter-presence mask of each word. Per-position letter
+ * statistics and a positional index (the words with letter X at position
+ * N) are gathered at build time as well.
+ *
+ * The arrays live in a dictionary image; this class is just a view of them.
+ */
+class WordColumns {
+public:
+
+    /// Bit (ch - 'a') is set if letter ch is present in the word
+    using LetterMask = uint32_t;
+
+    // -- Methods
+
+    /// Build the store for a word list into an image; the positional index
+    /// may be left out to save memory
+    static void Build(const PackedWords& words, ImageWriter& out,
+        bool positional_index = true);
+    /// Load a view of a store written by Build
+    bool Load(ImageReader& in) noexcept;
+    /// Returns the image bytes Build writes for the store
+    static size_t GetImageBytes(size_t word_count, size_t word_size, bool positional_index);
+
+    /// Returns the number of words in the store
+    size_t GetWordCount() const noexcept { return m_word_count; }
+    /// Returns the length of each word
+    size_t GetWordSize() const noexcept { return m_word_size; }
+
+    /// Returns letter pos of every word
+    std::span<const uint8_t> GetColumn(size_t pos) const noexcept
+        { return m_columns.subspan(pos * m_word_count, m_word_count); }
+    /// Returns the letter mask of every word
+    std::span<const LetterMask> GetMasks() const noexcept
+        { return m_masks; }
+
+    // - Statistics and index
+
+    /// Returns the number of words with letter ch at pos
+    size_t GetLetterCount(size_t pos, char ch) const noexcept
+        { return LetterBit(ch) ? m_letter_counts[pos * 26 + (ch - 'a')] : 0; }
+    /// Returns the number of words containing letter ch
+    size_t GetPresenceCount(char ch) const noexcept
+        { return LetterBit(ch) ? m_presence_counts[ch - 'a'] : 0; }
+    /// Returns the number of words with a repeated letter
+    size_t GetRepeatCount() const noexcept { return m_repeat_count; }
+    /// Returns true if the store has a positional index
+    bool HasPostings() const noexcept { return !m_posting_offsets.empty(); }
+    /// Returns the (ascending) indices of the words with letter ch at pos
+    std::span<const uint32_t> GetPostings(size_t pos, char ch) const noexcept;
+
+    /// Returns true if word w has a repeated letter (or a non a-z character)
+    bool HasRepeat(size_t w) const noexcept
+        { return static_cast<size_t>(std::popcount(m_masks[w])) < m_word_size; }
+
+    // - Filters
+
+    /// Clear keep[w] for words missing a required letter or having a forbidden one
+    void KeepIfMask(LetterMask required, LetterMask forbidden, std::vector<uint8_t>& keep) const;
+    /// Clear keep[w] for words that do not have letter ch at pos
+    void KeepIfLetterAt(size_t pos, char ch, std::vector<uint8_t>& keep) const;
+    /// Clear keep[w] for words that have letter ch at pos
+    void KeepIfLetterNotAt(size_t pos, char ch, std::vector<uint8_t>& keep) const;
+    /// Clear keep[w] for words whose letter at pos isn't in letters; others
+    /// says whether a character that isn't a letter (a..z) may be there
+    void KeepIfLetterIn(size_t pos, LetterMask letters, bool others,
+        std::vector<uint8_t>& keep) const;
+
+    /// Returns the mask bit for ch, or 0 if ch is not a lower case letter
+    static constexpr LetterMask LetterBit(char ch) noexcept
+        { return ((ch >= 'a') && (ch <= 'z')) ? (LetterMask(1) << (ch - 'a')) : 0; }
+    /// Returns the letter mask for a word
+    static LetterMask MakeMask(std::string_view word) noexcept;
+
+private:
+
+    size_t                      m_word_count{0};    ///< Number of words
+    size_t                      m_word_size{0};     ///< Letters per word
+    std::span<const uint8_t>    m_columns;          ///< m_word_size columns of m_word_count letters
+    std::span<const LetterMask> m_masks;            ///< Letter mask of each word
+
+    std::span<const uint32_t>   m_letter_counts;    ///< Words with letter L at pos P: [P*26+L]
+    std::span<const uint32_t>   m_presence_counts;  ///< Words containing letter L: [L]
+    size_t                      m_repeat_count{0};  ///< Words with a repeated letter
+    std::span<const uint32_t>   m_postings;         ///< Word indices grouped by [P*26+L]
+    std::span<const uint32_t>   m_posting_offsets;  ///< Start of group [P*26+L] in m_postings
+};
+
+#endif // ifndef word_columns__header_included
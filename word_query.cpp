@@ -0,0 +1,250 @@
+/**
+ * @file    word_query.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements WordQuery; crossword-style pattern queries for --list
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <fmt/format.h>
+#include <algorithm>
+#include <limits>
+
+#include "word_query.h"
+
+// Relative cost per word checked of each kind of predicate. A mask is one
+// AND over a packed array, and the index visits only the words with its
+// letter. A position compares a byte column. A repeat check takes a
+// popcount per word and has no vectorized scan.
+static constexpr double mask_cost       = 0.5;
+static constexpr double index_cost      = 0.25;
+static constexpr double position_cost   = 1.0;
+static constexpr double repeat_cost     = 2.0;
+
+/// Use the index for a positional predicate keeping at most this fraction
+static constexpr double index_threshold = 0.25;
+
+/// Compile query text against a word store; returns false on error
+bool WordQuery::Compile(std::string_view text, const WordColumns& columns, std::string& error)
+{
+    m_plan.clear();
+
+    const size_t ws = columns.GetWordSize();
+    const double n  = columns.GetWordCount() ? double(columns.GetWordCount()) : 1.0;
+
+    Predicate mask{Predicate::Kind::Mask};
+    mask.cost = mask_cost;
+
+    // Add positional predicates for each letter of text starting at pos
+    auto add_positions = [&](std::string_view letters, size_t pos) {
+        for (size_t i = 0; i < letters.length(); ++i) {
+            if ((letters[i] == '?') || (letters[i] == '.'))
+                continue;
+            Predicate p{Predicate::Kind::Position};
+            p.pos = pos + i;
+            p.ch  = letters[i];
+            p.selectivity = columns.GetLetterCount(p.pos, p.ch) / n;
+            p.cost = position_cost;
+            m_plan.push_back(p);
+        }
+    };
+    // All letters must be a-z (or a wildcard, if allowed)
+    auto valid_letters = [](std::string_view letters, bool wild) {
+        return std::all_of(letters.begin(), letters.end(), [wild](char ch) {
+            return WordColumns::LetterBit(ch) || (wild && ((ch == '?') || (ch == '.')));
+        });
+    };
+
+    // Split text into terms
+    constexpr std::string_view seps(" ,\t");
+    size_t start = 0;
+    while ((start = text.find_first_not_of(seps, start)) != std::string_view::npos) {
+        auto end = text.find_first_of(seps, start);
+        if (end == std::string_view::npos)
+            end = text.length();
+        std::string_view term = text.substr(start, end - start);
+        start = end;
+
+        if ((term == ":double") || (term == ":single")) {
+            Predicate p{Predicate::Kind::Repeat};
+            p.repeat = (term == ":double");
+            p.cost = repeat_cost;
+            p.selectivity = columns.GetRepeatCount() / n;
+            if (!p.repeat)
+                p.selectivity = 1.0 - p.selectivity;
+            m_plan.push_back(p);
+        }
+        else if (term.starts_with('+') || term.starts_with('-')) {
+            std::string_view letters = term.substr(1);
+            if (letters.empty() || !valid_letters(letters, false)) {
+                error = fmt::format("Invalid letter set: {}", term);
+                return false;
+            }
+            auto& m = term.starts_with('+') ? mask.required : mask.forbidden;
+            m |= WordColumns::MakeMask(letters);
+        }
+        else if (term.ends_with('*') || term.starts_with('*')) {
+            const bool prefix = term.ends_with('*');
+            std::string_view letters = prefix ? term.substr(0, term.length() - 1) : term.substr(1);
+            if (letters.empty() || (letters.length() > ws) || !valid_letters(letters, true)) {
+                error = fmt::format("Invalid {}: {}", prefix ? "prefix" : "suffix", term);
+                return false;
+            }
+            add_positions(letters, prefix ? 0 : ws - letters.length());
+        }
+        else if ((term.length() == ws) && valid_letters(term, true))
+            add_positions(term, 0);
+        else {
+            error = fmt::format("Invalid query term: {}", term);
+            return false;
+        }
+    }
+
+    // All letter set terms fold into a single mask predicate
+    if (mask.required || mask.forbidden) {
+        for (char ch = 'a'; ch <= 'z'; ++ch) {
+            const double present = columns.GetPresenceCount(ch) / n;
+            if (mask.required & WordColumns::LetterBit(ch))
+                mask.selectivity *= present;
+            if (mask.forbidden & WordColumns::LetterBit(ch))
+                mask.selectivity *= 1.0 - present;
+        }
+        m_plan.push_back(mask);
+    }
+
+    // Order by cost per word eliminated: cheap, selective predicates first
+    auto rank = [](const Predicate& p) {
+        return (p.selectivity < 1.0) ? p.cost / (1.0 - p.selectivity)
+                                     : std::numeric_limits<double>::infinity();
+    };
+    std::stable_sort(m_plan.begin(), m_plan.end(),
+        [&rank](const Predicate& a, const Predicate& b) { return rank(a) < rank(b); });
+
+    // The most selective positional predicate can be answered from the
+    // positional index (if there is one) instead of scanning its column;
+    // it goes first if that makes it the cheapest per word eliminated.
+    // Only the first predicate can seed the candidates this way.
+    if (columns.HasPostings()) {
+        auto best = m_plan.end();
+        for (auto it = m_plan.begin(); it != m_plan.end(); ++it) {
+            if ((it->kind == Predicate::Kind::Position) && (it->selectivity < index_threshold) &&
+                ((best == m_plan.end()) || (it->selectivity < best->selectivity)))
+            {
+                best = it;
+            }
+        }
+        if (best != m_plan.end()) {
+            Predicate indexed = *best;
+            indexed.kind = Predicate::Kind::Index;
+            indexed.cost = index_cost;
+            if ((best == m_plan.begin()) || (rank(indexed) < rank(m_plan.front()))) {
+                m_plan.erase(best);
+                m_plan.insert(m_plan.begin(), indexed);
+            }
+        }
+    }
+
+    return true;
+}
+
+/// Clear keep[w] for every word that does not satisfy the query
+void WordQuery::Apply(const WordColumns& columns, std::vector<uint8_t>& keep) const
+{
+    if (m_plan.empty())
+        return;
+
+    // The first predicate runs over every word, either through the index
+    // or as a vectorized scan. The rest only see the surviving candidates.
+    std::vector<uint32_t> cand;
+    auto next = m_plan.begin();
+    if (next->kind == Predicate::Kind::Index) {
+        for (auto w : columns.GetPostings(next->pos, next->ch)) {
+            if (keep[w])
+                cand.push_back(w);
+        }
+        ++next;
+    }
+    else {
+        switch (next->kind) {
+        case Predicate::Kind::Mask:
+            columns.KeepIfMask(next->required, next->forbidden, keep);
+            ++next;
+            break;
+        case Predicate::Kind::Position:
+            columns.KeepIfLetterAt(next->pos, next->ch, keep);
+            ++next;
+            break;
+        default:
+            break;      // No scan for this one; checked per candidate below
+        }
+
+        for (uint32_t w = 0; w < keep.size(); ++w) {
+            if (keep[w])
+                cand.push_back(w);
+        }
+    }
+
+    for (; next != m_plan.end(); ++next) {
+        const Predicate& p = *next;
+        std::erase_if(cand, [&](uint32_t w) { return !Check(columns, p, w); });
+    }
+
+    std::fill(keep.begin(), keep.end(), 0);
+    for (auto w : cand)
+        keep[w] = 1;
+}
+
+/// Returns true if word w satisfies the predicate
+bool WordQuery::Check(const WordColumns& columns, const Predicate& p, uint32_t w)
+{
+    switch (p.kind) {
+    case Predicate::Kind::Mask: {
+        const auto m = columns.GetMasks()[w];
+        return ((m & p.required) == p.required) && ((m & p.forbidden) == 0);
+    }
+    case Predicate::Kind::Index:
+    case Predicate::Kind::Position:
+        return columns.GetColumn(p.pos)[w] == static_cast<uint8_t>(p.ch);
+    case Predicate::Kind::Repeat:
+        return columns.HasRepeat(w) == p.repeat;
+    }
+
+    return false;
+}
+
+/// Returns a human readable description of the plan
+std::string WordQuery::DescribePlan() const
+{
+    auto letters = [](WordColumns::LetterMask m) {
+        std::string s;
+        for (char ch = 'a'; ch <= 'z'; ++ch) {
+            if (m & WordColumns::LetterBit(ch))
+                s.push_back(ch);
+        }
+        return s;
+    };
+
+    std::string desc;
+    for (size_t i = 0; i < m_plan.size(); ++i) {
+        const Predicate& p = m_plan[i];
+        std::string what;
+        switch (p.kind) {
+        case Predicate::Kind::Mask:
+            what = fmt::format("mask     +{} -{}", letters(p.required), letters(p.forbidden));
+            break;
+        case Predicate::Kind::Index:
+            what = fmt::format("index    '{}' at {}", p.ch, p.pos + 1);
+            break;
+        case Predicate::Kind::Position:
+            what = fmt::format("position '{}' at {}", p.ch, p.pos + 1);
+            break;
+        case Predicate::Kind::Repeat:
+            what = fmt::format("repeat   {}", p.repeat ? "yes" : "no");
+            break;
+        }
+        desc += fmt::format("  {}. {:24} est. {:5.1f}% kept, cost {:.2f}\n", i + 1, what,
+            100.0 * p.selectivity, p.cost);
+    }
+
+    return desc;
+}
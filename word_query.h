@@ -0,0 +1,82 @@
+/**
+ * @file    word_query.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares WordQuery; crossword-style pattern queries for --list
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef word_query__header_included
+#define word_query__header_included
+
+#include <string_view>
+#include <cstdint>
+#include <vector>
+#include <string>
+
+#include "word_columns.h"
+
+/**
+ * @brief A compiled word query
+ *
+ * A query is a list of terms separated by spaces or commas:
+ *  - a??le     Pattern; one character per letter, '?' or '.' is any letter
+ *  - ab*       Word starts with "ab"
+ *  - *er       Word ends with "er"
+ *  - +rt       Word contains r and t
+ *  - -e        Word does not contain e
+ *  - :double   Word has a repeated letter
+ *  - :single   Word has no repeated letters
+ *
+ * Terms compile into a plan of predicates ordered by estimated cost per
+ * word eliminated, so that cheap and selective predicates run first.
+ * Selectivity is estimated from the letter statistics that WordColumns
+ * gathers at load; cost depends on the kind of predicate (a mask or index
+ * lookup is cheaper than a column scan, which is cheaper than a repeat
+ * check).
+ */
+class WordQuery {
+public:
+
+    // -- Methods
+
+    /// Compile query text against a word store; returns false on error
+    bool Compile(std::string_view text, const WordColumns& columns, std::string& error);
+
+    /// Clear keep[w] for every word that does not satisfy the query
+    void Apply(const WordColumns& columns, std::vector<uint8_t>& keep) const;
+
+    /// Returns a human readable description of the plan
+    std::string DescribePlan() const;
+
+    /// Returns true if the query has no predicates
+    bool IsEmpty() const noexcept { return m_plan.empty(); }
+
+private:
+
+    /// A single step of the query plan
+    struct Predicate {
+        enum class Kind {
+            Mask,       ///< Required/forbidden letter masks
+            Index,      ///< Positional letter; seeds candidates from the index
+            Position,   ///< Positional letter; checked against the column
+            Repeat,     ///< Word has (or does not have) a repeated letter
+        };
+
+        Kind                    kind;
+        size_t                  pos{0};         ///< Position (Index, Position)
+        char                    ch{0};          ///< Letter (Index, Position)
+        WordColumns::LetterMask required{0};    ///< Mask
+        WordColumns::LetterMask forbidden{0};   ///< Mask
+        bool                    repeat{true};   ///< Repeat: wanted value
+        double                  selectivity{1}; ///< Estimated fraction of words kept
+        double                  cost{1};        ///< Estimated cost per word checked
+    };
+
+    /// Returns true if word w satisfies the predicate
+    static bool Check(const WordColumns& columns, const Predicate& p, uint32_t w);
+
+    std::vector<Predicate>  m_plan;             ///< Predicates in execution order
+};
+
+#endif // ifndef word_query__header_included
@@ -0,0 +1,350 @@
+/**
+ * @file    word_sets.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements word sets; word lists as sorted integer keys
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "word_sets.h"
+
+/// Bits per letter in a key
+static constexpr uint32_t key_letter_bits = 5;
+
+/// Intersect by searching the larger set when the other is this many
+/// times smaller; merging would mostly step over the larger one
+static constexpr size_t gallop_ratio = 32;
+
+/// Returns the key for a word, or 0 if it isn't all letters (a..z)
+uint64_t WordSet::MakeKey(std::string_view word) noexcept
+{
+    uint64_t key = 0;
+    for (char ch : word) {
+        if ((ch >= 'A') && (ch <= 'Z'))
+            ch += 'a' - 'A';
+        if ((ch < 'a') || (ch > 'z'))
+            return 0;
+        key = (key << key_letter_bits) | uint64_t(ch - 'a' + 1);
+    }
+    return key;
+}
+
+/// Returns the word for a key
+std::string WordSet::GetWord(uint64_t key, size_t word_size)
+{
+    std::string word(word_size, ' ');
+    for (size_t p = word_size; p--; key >>= key_letter_bits)
+        word[p] = static_cast<char>('a' + (key & ((1 << key_letter_bits) - 1)) - 1);
+    return word;
+}
+
+/// Sort the keys and remove duplicates; a duplicate keeps its first weight
+void WordSet::Normalize()
+{
+    if (!std::is_sorted(keys.begin(), keys.end())) {
+        std::vector<uint32_t> order(keys.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+            [this](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+        std::vector<uint64_t> sorted_keys(keys.size());
+        std::vector<float> sorted_weights(keys.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            sorted_keys[i] = keys[order[i]];
+            sorted_weights[i] = weights[order[i]];
+        }
+        keys = std::move(sorted_keys);
+        weights = std::move(sorted_weights);
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (n && (keys[n - 1] == keys[i]))
+            continue;
+        keys[n] = keys[i];
+        weights[n++] = weights[i];
+    }
+    keys.resize(n);
+    weights.resize(n);
+}
+
+/// Read a word list, text or binary
+bool WordSet::Read(const std::string& path, size_t size)
+{
+    word_size = size;
+    keys.clear();
+    weights.clear();
+    weighted = false;
+
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) {
+        fmt::print(std::cerr, "mrdle: Failed to open word file: {}\n", path);
+        return false;
+    }
+    const std::string data{std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+
+    if (data.starts_with(binary_magic)) {
+        uint64_t header[2] = {0, 0};
+        if (data.size() >= binary_magic.size() + sizeof(header))
+            std::memcpy(header, data.data() + binary_magic.size(), sizeof(header));
+        const size_t offset = binary_magic.size() + sizeof(header);
+        if (!word_size)
+            word_size = header[0];
+        const size_t keys_end = offset + header[1] * sizeof(uint64_t);
+        weighted = (data.size() == keys_end + header[1] * sizeof(float));
+        if ((header[0] != word_size) || ((data.size() != keys_end) && !weighted)) {
+            fmt::print(std::cerr, "Invalid word file: Bad binary word set: {}\n", path);
+            return false;
+        }
+        keys.resize(header[1]);
+        std::memcpy(keys.data(), data.data() + offset, keys.size() * sizeof(uint64_t));
+        weights.assign(keys.size(), 1.0f);
+        if (weighted)
+            std::memcpy(weights.data(), data.data() + keys_end, weights.size() * sizeof(float));
+        Normalize();
+        return true;
+    }
+
+    // Scan the text in place; a word is the first token on its line and
+    // its frequency, if any, the second
+    keys.reserve(data.size() / (word_size + 1));
+    weights.reserve(keys.capacity());
+    const char* p = data.data();
+    const char* const end = p + data.size();
+    while (p < end) {
+        while ((p < end) && ((*p == ' ') || (*p == '\t') || (*p == '\r')))
+            ++p;
+        const char* word = p;
+        while ((p < end) && (*p != ' ') && (*p != '\t') && (*p != '\r') && (*p != '\n'))
+            ++p;
+        const std::string_view w(word, p - word);
+        while ((p < end) && ((*p == ' ') || (*p == '\t')))
+            ++p;
+        const char* freq = p;
+        while ((p < end) && (*p != '\n'))
+            ++p;
+        std::string_view f(freq, p - freq);
+        while (!f.empty() && ((f.back() == ' ') || (f.back() == '\t') || (f.back() == '\r')))
+            f.remove_suffix(1);
+        if (p < end)
+            ++p;
+
+        if (w.empty())
+            continue;
+        if (!word_size)
+            word_size = w.length();
+        if (word_size > max_set_word_size) {
+            fmt::print(std::cerr, "mrdle: Set operations need words of at most {} letters\n",
+                max_set_word_size);
+            keys.clear();
+            return false;
+        }
+        if (w.length() != word_size) {
+            fmt::print(std::cerr, "Invalid word file: Inconsistent word length: {} ({})\n", w, path);
+            keys.clear();
+            return false;
+        }
+        const uint64_t key = MakeKey(w);
+        if (!key) {
+            fmt::print(std::cerr, "Invalid word file: Bad word: {} ({})\n", w, path);
+            keys.clear();
+            return false;
+        }
+        float weight = 1.0f;
+        if (!f.empty()) {
+            const std::string text(f);
+            char* text_end = nullptr;
+            const double v = std::strtod(text.c_str(), &text_end);
+            if ((text_end != text.c_str() + text.length()) || !std::isfinite(v) || (v < 0)) {
+                fmt::print(std::cerr, "Invalid word file: Bad frequency: {} {} ({})\n", w, f, path);
+                keys.clear();
+                weights.clear();
+                return false;
+            }
+            weight = static_cast<float>(v);
+            weighted = true;
+        }
+        Add(key, weight);
+    }
+
+    Normalize();
+    return true;
+}
+
+/// Write the words as text, one per line, or in the binary format
+bool WordSet::Write(const std::string& path, bool binary) const
+{
+    std::string data;
+    if (binary) {
+        const uint64_t header[2] = {word_size, keys.size()};
+        data.reserve(binary_magic.size() + sizeof(header) + keys.size() * sizeof(uint64_t) +
+            (weighted ? weights.size() * sizeof(float) : 0));
+        data.append(binary_magic);
+        data.append(reinterpret_cast<const char*>(header), sizeof(header));
+        data.append(reinterpret_cast<const char*>(keys.data()), keys.size() * sizeof(uint64_t));
+        if (weighted)
+            data.append(reinterpret_cast<const char*>(weights.data()), weights.size() * sizeof(float));
+    }
+    else if (weighted) {
+        for (size_t i = 0; i < keys.size(); ++i)
+            fmt::format_to(std::back_inserter(data), "{} {}\n", GetWord(keys[i], word_size), weights[i]);
+    }
+    else {
+        data.resize(keys.size() * (word_size + 1));
+        char* out = data.data();
+        for (auto key : keys) {
+            for (size_t p = word_size; p--; key >>= key_letter_bits)
+                out[p] = static_cast<char>('a' + (key & ((1 << key_letter_bits) - 1)) - 1);
+            out[word_size] = '\n';
+            out += word_size + 1;
+        }
+    }
+
+    if (path.empty() || (path == "-")) {
+        std::cout.write(data.data(), data.size());
+        return std::cout.good();
+    }
+    std::ofstream ofs(path, std::ios::binary);
+    ofs.write(data.data(), data.size());
+    return ofs.good();
+}
+
+// The merges below are branch free: each step does the same work whichever
+// side is smaller, so there are no mispredicted branches to pay for, and
+// the compiler turns the selects into conditional moves.
+
+/// Words in either set
+WordSet Union(const WordSet& a, const WordSet& b)
+{
+    WordSet out;
+    out.word_size = a.word_size;
+    out.weighted = a.weighted || b.weighted;
+    out.keys.resize(a.keys.size() + b.keys.size());
+    out.weights.resize(out.keys.size());
+    const uint64_t* x = a.keys.data(), * const x_end = x + a.keys.size();
+    const uint64_t* y = b.keys.data(), * const y_end = y + b.keys.size();
+    const float* xw = a.weights.data(), * yw = b.weights.data();
+    uint64_t* o = out.keys.data();
+    float* ow = out.weights.data();
+    while ((x < x_end) && (y < y_end)) {
+        const uint64_t u = *x, v = *y;
+        *o++ = (u < v) ? u : v;
+        *ow++ = (u <= v) ? *xw : *yw;
+        x += (u <= v);
+        xw += (u <= v);
+        y += (v <= u);
+        yw += (v <= u);
+    }
+    ow = std::copy(xw, xw + (x_end - x), ow);
+    std::copy(yw, yw + (y_end - y), ow);
+    o = std::copy(x, x_end, o);
+    o = std::copy(y, y_end, o);
+    out.keys.resize(o - out.keys.data());
+    out.weights.resize(out.keys.size());
+    return out;
+}
+
+/// Words in both sets
+WordSet Intersect(const WordSet& a, const WordSet& b)
+{
+    const WordSet& small = (a.keys.size() <= b.keys.size()) ? a : b;
+    const WordSet& large = (a.keys.size() <= b.keys.size()) ? b : a;
+
+    WordSet out;
+    out.word_size = a.word_size;
+    out.weighted = a.weighted;
+    out.keys.resize(small.keys.size());
+    out.weights.resize(out.keys.size());
+    uint64_t* o = out.keys.data();
+    float* ow = out.weights.data();
+
+    if (small.keys.size() * gallop_ratio < large.keys.size()) {
+        // Gallop: search ahead in the larger set for each key of the smaller
+        auto it = large.keys.begin();
+        for (size_t i = 0; i < small.keys.size(); ++i) {
+            const uint64_t key = small.keys[i];
+            size_t step = 1;
+            auto hi = it;
+            while ((hi != large.keys.end()) && (*hi < key)) {
+                it = hi;
+                hi = (size_t(large.keys.end() - hi) > step) ? hi + step : large.keys.end();
+                step *= 2;
+            }
+            it = std::lower_bound(it, hi, key);
+            if ((it != large.keys.end()) && (*it == key)) {
+                *o++ = key;
+                *ow++ = (&small == &a) ? a.weights[i] : a.weights[it - large.keys.begin()];
+            }
+        }
+    }
+    else {
+        const uint64_t* x = a.keys.data(), * const x_end = x + a.keys.size();
+        const uint64_t* y = b.keys.data(), * const y_end = y + b.keys.size();
+        const float* xw = a.weights.data();
+        while ((x < x_end) && (y < y_end)) {
+            const uint64_t u = *x, v = *y;
+            *o = u;
+            *ow = *xw;
+            o += (u == v);
+            ow += (u == v);
+            x += (u <= v);
+            xw += (u <= v);
+            y += (v <= u);
+        }
+    }
+
+    out.keys.resize(o - out.keys.data());
+    out.weights.resize(out.keys.size());
+    return out;
+}
+
+/// Words in a but not in b
+WordSet Difference(const WordSet& a, const WordSet& b)
+{
+    WordSet out;
+    out.word_size = a.word_size;
+    out.weighted = a.weighted;
+    out.keys.resize(a.keys.size());
+    out.weights.resize(out.keys.size());
+    const uint64_t* x = a.keys.data(), * const x_end = x + a.keys.size();
+    const uint64_t* y = b.keys.data(), * const y_end = y + b.keys.size();
+    const float* xw = a.weights.data();
+    uint64_t* o = out.keys.data();
+    float* ow = out.weights.data();
+    while ((x < x_end) && (y < y_end)) {
+        const uint64_t u = *x, v = *y;
+        *o = u;
+        *ow = *xw;
+        o += (u < v);
+        ow += (u < v);
+        x += (u <= v);
+        xw += (u <= v);
+        y += (v <= u);
+    }
+    std::copy(xw, xw + (x_end - x), ow);
+    o = std::copy(x, x_end, o);
+    out.keys.resize(o - out.keys.data());
+    out.weights.resize(out.keys.size());
+    return out;
+}
+
+/// Combine two sets
+WordSet Combine(SetOperation op, const WordSet& a, const WordSet& b)
+{
+    switch (op) {
+    case SetOperation::Union:       return Union(a, b);
+    case SetOperation::Intersect:   return Intersect(a, b);
+    case SetOperation::Diff:
+    default:                        return Difference(a, b);
+    }
+}
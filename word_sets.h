@@ -0,0 +1,83 @@
+/**
+ * @file    word_sets.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares word sets; word lists as sorted integer keys
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef word_sets__header_included
+#define word_sets__header_included
+
+#include <string_view>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Longest word a key holds; 5 bits per letter
+constexpr size_t max_set_word_size = 12;
+
+/**
+ * @brief A set of same-length words as sorted, distinct integer keys
+ *
+ * A key packs a word's letters 5 bits apiece, first letter highest, so
+ * keys sort in the same order as the words. Set operations merge the key
+ * arrays without looking at a single string, so combining lists costs
+ * little more than reading and writing them.
+ */
+struct WordSet {
+    size_t                  word_size{0};
+    std::vector<uint64_t>   keys;           ///< Sorted, no duplicates
+    std::vector<float>      weights;        ///< By key; 1 for words without one
+    bool                    weighted{false};///< Some word had a frequency
+
+    /// Binary files start with this, followed by the word size and count
+    /// (uint64 each), the keys and, for a weighted set, the weights
+    static constexpr std::string_view binary_magic = "mrdlekey";
+
+    /// Returns the key for a word, or 0 if it isn't all letters (a..z)
+    static uint64_t MakeKey(std::string_view word) noexcept;
+    /// Returns the word for a key
+    static std::string GetWord(uint64_t key, size_t word_size);
+
+    /// Add a word by key
+    void Add(uint64_t key, float weight = 1.0f) { keys.push_back(key); weights.push_back(weight); }
+    /// Sort the keys and remove duplicates; a duplicate keeps its first weight
+    void Normalize();
+
+    /**
+     * @brief Read a word list, text or binary
+     *
+     * Text files are one word per line, optionally followed by the word's
+     * frequency as in any word file; case is folded. Prints a message and
+     * returns false if the file can't be read or has a bad word.
+     *
+     * @param word_size Length every word must have; 0 for the length of
+     *  the first word
+     */
+    bool Read(const std::string& path, size_t word_size);
+    /// Write the words (and weights) as text, one per line, or in the
+    /// binary format
+    bool Write(const std::string& path, bool binary) const;
+};
+
+/// Ways of combining word sets
+enum class SetOperation {
+    Union,      ///< --union; words in either
+    Intersect,  ///< --intersect; words in both
+    Diff,       ///< --diff; words in the first but not the second
+};
+
+// Results keep the first set's weights; a union takes the second set's
+// weights for words only it has.
+
+/// Combine two sets
+WordSet Combine(SetOperation op, const WordSet& a, const WordSet& b);
+/// Words in either set
+WordSet Union(const WordSet& a, const WordSet& b);
+/// Words in both sets
+WordSet Intersect(const WordSet& a, const WordSet& b);
+/// Words in a but not in b
+WordSet Difference(const WordSet& a, const WordSet& b);
+
+#endif // ifndef word_sets__header_included
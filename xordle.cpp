@@ -0,0 +1,181 @@
+/**
+ * @file    xordle.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements Xordle support; two secrets that share no letters
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <array>
+#include <cmath>
+
+#include "xordle.h"
+
+ClueCombiner::ClueCombiner(size_t word_size)
+    : m_count(WordleFeedback::GetPatternCount(word_size)), m_table(m_count * m_count)
+{
+    for (size_t a = 0; a < m_count; ++a) {
+        for (size_t b = 0; b < m_count; ++b)
+            m_table[a * m_count + b] = Combine(static_cast<Pattern>(a), static_cast<Pattern>(b), word_size);
+    }
+}
+
+/// Combine two patterns a digit at a time
+Pattern ClueCombiner::Combine(Pattern a, Pattern b, size_t word_size) noexcept
+{
+    Pattern combined = 0, weight = 1;
+    for (size_t i = 0; i < word_size; ++i, a /= 3, b /= 3, weight = static_cast<Pattern>(weight * 3))
+        combined = static_cast<Pattern>(combined + std::max(a % 3, b % 3) * weight);
+    return combined;
+}
+
+/// Find every pair of words that share no letters and satisfy the clues
+std::vector<WordPair> FindPairs(const Dictionary& dict, std::span<const uint32_t> words,
+    std::span<const PairClue> clues)
+{
+    const size_t ws = dict.GetWordSize();
+    if (!ws || (ws > max_xordle_word_size))
+        return {};
+
+    // Clue letters get a bit each in the cover masks while there's room;
+    // clues past that are checked against the pairs themselves
+    const size_t masked = std::min(clues.size(), 64 / ws);
+    std::vector<uint64_t> cover(words.size(), 0);
+    std::vector<uint8_t> fits(words.size(), 1);
+    std::vector<std::vector<Pattern>> late_rows;
+    uint64_t need = 0;
+
+    std::vector<Pattern> row(dict.GetWordCount());
+    for (size_t h = 0; h < clues.size(); ++h) {
+        WordleFeedback::ComputeRow(dict.GetColumns(), clues[h].guess, row);
+
+        std::array<Pattern, max_xordle_word_size> want{};
+        for (Pattern i = 0, c = clues[h].clue; i < ws; ++i, c /= 3)
+            want[i] = c % 3;
+        const size_t shift = h * ws;
+        if (h < masked) {
+            for (size_t i = 0; i < ws; ++i)
+                need |= uint64_t(want[i] != pattern_missing) << (shift + i);
+        }
+
+        for (size_t k = 0; k < words.size(); ++k) {
+            Pattern p = row[words[k]];
+            uint64_t bits = 0;
+            for (size_t i = 0; i < ws; ++i, p /= 3) {
+                const Pattern d = p % 3;
+                fits[k] &= (d <= want[i]);
+                bits |= uint64_t((d == want[i]) & (d != pattern_missing)) << i;
+            }
+            if (h < masked)
+                cover[k] |= bits << shift;
+        }
+        if (h >= masked)
+            late_rows.push_back(row);
+    }
+
+    // Group the words that fit by what they cover
+    std::vector<uint32_t> order;
+    for (uint32_t k = 0; k < words.size(); ++k) {
+        if (fits[k])
+            order.push_back(k);
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&cover](uint32_t a, uint32_t b) { return cover[a] < cover[b]; });
+    std::vector<size_t> starts;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (!i || (cover[order[i]] != cover[order[i - 1]]))
+            starts.push_back(i);
+    }
+    starts.push_back(order.size());
+
+    const auto masks = dict.GetColumns().GetMasks();
+    std::vector<WordPair> pairs;
+    for (size_t gi = 0; gi + 1 < starts.size(); ++gi) {
+        for (size_t gj = gi; gj + 1 < starts.size(); ++gj) {
+            if ((cover[order[starts[gi]]] | cover[order[starts[gj]]]) != need)
+                continue;
+
+            for (size_t i = starts[gi]; i < starts[gi + 1]; ++i) {
+                const uint32_t a = words[order[i]];
+                const auto mask_a = masks[a];
+                const size_t j_start = (gi == gj) ? i + 1 : starts[gj];
+                const size_t j_end = starts[gj + 1];
+
+                // Write every pair and advance past the ones that share no letters
+                size_t n = pairs.size();
+                pairs.resize(n + (j_end - j_start));
+                for (size_t j = j_start; j < j_end; ++j) {
+                    const uint32_t b = words[order[j]];
+                    pairs[n] = WordPair{std::min(a, b), std::max(a, b)};
+                    n += !(mask_a & masks[b]);
+                }
+                pairs.resize(n);
+            }
+        }
+    }
+
+    if (!late_rows.empty()) {
+        const ClueCombiner combine(ws);
+        for (size_t h = masked; h < clues.size(); ++h) {
+            const auto& late = late_rows[h - masked];
+            std::erase_if(pairs, [&](const WordPair& p)
+                { return combine(late[p.first], late[p.second]) != clues[h].clue; });
+        }
+    }
+
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+/// Score every word as a guess against the pairs
+std::vector<PairScore> ScorePairGuesses(PatternStore& store, std::span<const WordPair> pairs,
+    size_t threads)
+{
+    const auto& dict = *store.GetDictionary();
+    const uint32_t word_count = static_cast<uint32_t>(dict.GetWordCount());
+    const ClueCombiner combine(dict.GetWordSize());
+
+    std::vector<uint8_t> in_pair(word_count, 0);
+    for (const auto& p : pairs)
+        in_pair[p.first] = in_pair[p.second] = 1;
+
+    std::vector<PairScore> scores(word_count);
+    const double total = static_cast<double>(pairs.size());
+    std::atomic<uint32_t> next_guess{0};
+    auto worker = [&]() {
+        std::vector<uint32_t> hist(store.GetPatternCount(), 0);
+        std::vector<Pattern> touched;
+        for (uint32_t g; (g = next_guess++) < word_count; ) {
+            const auto row_ptr = store.GetRow(g);
+            const Pattern* row = row_ptr->data();
+            for (const auto& p : pairs) {
+                const Pattern c = combine(row[p.first], row[p.second]);
+                if (0 == hist[c]++)
+                    touched.push_back(c);
+            }
+
+            PairScore sc{g, 0, touched.size(), bool(in_pair[g])};
+            for (auto c : touched) {
+                const double f = hist[c] / total;
+                sc.bits -= f * std::log2(f);
+                hist[c] = 0;
+            }
+            scores[g] = sc;
+            touched.clear();
+        }
+    };
+
+    size_t thread_count = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::min<size_t>(thread_count, word_count);
+    {
+        std::vector<std::jthread> pool;
+        for (size_t t = 1; t < thread_count; ++t)
+            pool.emplace_back(worker);
+        worker();
+    }
+
+    return scores;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file    xordle.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares Xordle support; two secrets that share no letters
+ *
+ * @copyright Copyright (c) 2022 Mike DeKoker
+ *
+ */
+#ifndef xordle__header_included
+#define xordle__header_included
+
+#include <cstdint>
+#include <compare>
+#include <string>
+#include <vector>
+#include <span>
+
+#include "pattern_store.h"
+#include "dictionary.h"
+
+/// Longest word Xordle handles; the clue table has (3^N)^2 entries
+constexpr size_t max_xordle_word_size = 6;
+
+/// Two secrets that share no letters; indexes into the dictionary, first
+/// less than second
+struct WordPair {
+    uint32_t    first{0};
+    uint32_t    second{0};
+
+    auto operator<=>(const WordPair&) const = default;
+};
+
+/// A guess and the clue it got against both secrets
+struct PairClue {
+    std::string guess;
+    Pattern     clue{0};
+};
+
+/**
+ * @brief The clue a guess gets against two secrets, from its pattern
+ *  against each
+ *
+ * A letter's result is the better of its results against either secret
+ * (matched over mislaid over missing). The secrets share no letters, so a
+ * letter can only be found in one of them. Combining is a table lookup.
+ */
+class ClueCombiner {
+public:
+
+    explicit ClueCombiner(size_t word_size);
+
+    Pattern operator()(Pattern a, Pattern b) const noexcept
+        { return m_table[a * m_count + b]; }
+
+    /// Combine two patterns a digit at a time
+    static Pattern Combine(Pattern a, Pattern b, size_t word_size) noexcept;
+
+private:
+    size_t                  m_count{0};     ///< Patterns for the word size
+    std::vector<Pattern>    m_table;        ///< [a * m_count + b]
+};
+
+/**
+ * @brief Find every pair of words that share no letters and satisfy the clues
+ *
+ * There are far too many pairs to check one at a time, so the clues are
+ * first checked against each word on its own. A word can only be in a
+ * pair if none of its results beats the clue's, and a pair only satisfies
+ * the clue if between them the words account for every letter the clue
+ * found. Each word gets a bit mask of the clue letters it accounts for,
+ * words are grouped by mask, and only groups whose masks together cover
+ * the clues are paired up; within those, the letter masks of the words
+ * are ANDed, without branching, to keep the pairs that share no letters.
+ * Pairs come out in order.
+ *
+ * @param words     Words that may be secrets (indexes into dict)
+ */
+std::vector<WordPair> FindPairs(const Dictionary& dict, std::span<const uint32_t> words,
+    std::span<const PairClue> clues);
+
+/// Entropy of the clues a guess would get against a set of pairs
+struct PairScore {
+    uint32_t    guess{0};           ///< Index into the dictionary
+    double      bits{0};
+    size_t      groups{0};          ///< Distinct clues
+    bool        candidate{false};   ///< Guess is one of the secrets of a pair
+};
+
+/**
+ * @brief Score every word as a guess against the pairs
+ *
+ * @param threads   Threads to score with; 0 for one per core
+ * @return Scores in word order
+ */
+std::vector<PairScore> ScorePairGuesses(PatternStore& store, std::span<const WordPair> pairs,
+    size_t threads = 0);
+
+#endif // ifndef xordle__header_included